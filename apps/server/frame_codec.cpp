@@ -0,0 +1,364 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_codec.h"
+#include "frame_header.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const size_t BLOCK_SIZE = 128;  // residuals sharing a bit width
+const size_t BAND_ROWS = 32;    // rows coded together
+const size_t DEFAULT_WIDTH = 1024;
+
+size_t max_band_size(size_t values) {
+    size_t blocks = (values + BLOCK_SIZE - 1) / BLOCK_SIZE;
+    return blocks + values * sizeof(uint16_t);
+}
+
+inline uint16_t zigzag(uint16_t value) {
+    return static_cast<uint16_t>((value << 1) ^ (0 - (value >> 15)));
+}
+
+inline uint16_t unzigzag(uint16_t value) {
+    return static_cast<uint16_t>((value >> 1) ^ (0 - (value & 1)));
+}
+
+// Residuals of a band: values predicted from the previous value of the same
+// lane, or from the row above for the first value of each lane
+void predict(const uint16_t *values, size_t width, size_t rows, size_t lanes,
+             uint16_t *residuals) {
+    for (size_t r = 0; r < rows; ++r) {
+        const uint16_t *row = values + r * width;
+        uint16_t *out = residuals + r * width;
+        for (size_t c = 0; c < lanes && c < width; ++c) {
+            uint16_t above = r ? row[c - width] : 0;
+            out[c] = zigzag(static_cast<uint16_t>(row[c] - above));
+        }
+        for (size_t c = lanes; c < width; ++c) {
+            out[c] = zigzag(static_cast<uint16_t>(row[c] - row[c - lanes]));
+        }
+    }
+}
+
+size_t pack(const uint16_t *residuals, size_t count, uint8_t *out) {
+    uint8_t *start = out;
+    for (size_t base = 0; base < count; base += BLOCK_SIZE) {
+        const size_t n = std::min(BLOCK_SIZE, count - base);
+        const uint16_t *block = residuals + base;
+
+        uint16_t all = 0;
+        for (size_t i = 0; i < n; ++i) {
+            all |= block[i];
+        }
+        unsigned bits = 0;
+        while (all >> bits) {
+            ++bits;
+        }
+        *out++ = static_cast<uint8_t>(bits);
+        if (!bits) {
+            continue;
+        }
+
+        uint64_t acc = 0;
+        unsigned filled = 0;
+        for (size_t i = 0; i < n; ++i) {
+            acc |= static_cast<uint64_t>(block[i]) << filled;
+            filled += bits;
+            if (filled >= 32) {
+                uint32_t word = static_cast<uint32_t>(acc);
+                memcpy(out, &word, sizeof(word));
+                out += sizeof(word);
+                acc >>= 32;
+                filled -= 32;
+            }
+        }
+        while (filled > 0) {
+            *out++ = static_cast<uint8_t>(acc);
+            acc >>= 8;
+            filled = filled > 8 ? filled - 8 : 0;
+        }
+    }
+    return out - start;
+}
+
+bool unpack(const uint8_t *data, size_t size, size_t count,
+            uint16_t *residuals) {
+    const uint8_t *end = data + size;
+    for (size_t base = 0; base < count; base += BLOCK_SIZE) {
+        const size_t n = std::min(BLOCK_SIZE, count - base);
+        if (data >= end) {
+            return false;
+        }
+        const unsigned bits = *data++;
+        if (bits > 16) {
+            return false;
+        }
+        if (!bits) {
+            std::fill(residuals + base, residuals + base + n, 0);
+            continue;
+        }
+        const size_t bytes = (n * bits + 7) / 8;
+        if (static_cast<size_t>(end - data) < bytes) {
+            return false;
+        }
+
+        const uint64_t mask = (1u << bits) - 1;
+        uint64_t acc = 0;
+        unsigned filled = 0;
+        const uint8_t *in = data;
+        for (size_t i = 0; i < n; ++i) {
+            while (filled < bits) {
+                acc |= static_cast<uint64_t>(*in++) << filled;
+                filled += 8;
+            }
+            residuals[base + i] = static_cast<uint16_t>(acc & mask);
+            acc >>= bits;
+            filled -= bits;
+        }
+        data += bytes;
+    }
+    return data == end;
+}
+
+void reconstruct(const uint16_t *residuals, size_t width, size_t rows,
+                 size_t lanes, uint16_t *values) {
+    for (size_t r = 0; r < rows; ++r) {
+        const uint16_t *in = residuals + r * width;
+        uint16_t *row = values + r * width;
+        for (size_t c = 0; c < lanes && c < width; ++c) {
+            uint16_t above = r ? row[c - width] : 0;
+            row[c] = static_cast<uint16_t>(above + unzigzag(in[c]));
+        }
+        for (size_t c = lanes; c < width; ++c) {
+            row[c] = static_cast<uint16_t>(row[c - lanes] + unzigzag(in[c]));
+        }
+    }
+}
+
+} // namespace
+
+void FrameCodec::addPlane(size_t offset, size_t width, size_t height,
+                          size_t lanes) {
+    for (size_t row = 0; row < height; row += BAND_ROWS) {
+        const size_t rows = std::min(BAND_ROWS, height - row);
+        FrameCodecSegment segment = {};
+        segment.rawOffset =
+            static_cast<uint32_t>(offset + row * width * sizeof(uint16_t));
+        segment.rawBytes =
+            static_cast<uint32_t>(rows * width * sizeof(uint16_t));
+        segment.width = static_cast<uint16_t>(width);
+        segment.lanes = static_cast<uint16_t>(lanes);
+        m_segments.push_back(segment);
+    }
+}
+
+bool FrameCodec::addSelectedPlanes(uint16_t content, size_t width,
+                                   size_t height, size_t frameSize) {
+    const size_t plane = width * height;
+    const size_t wide = 2 * width;
+    if (!width || wide > UINT16_MAX) {
+        return false;
+    }
+
+    size_t size = 0;
+    size += (content & FRAME_CONTENT_DEPTH) ? plane * 2 : 0;
+    size += (content & FRAME_CONTENT_AB) ? plane * 2 : 0;
+    size += (content & FRAME_CONTENT_CONF) ? plane * 4 : 0;
+    size += (content & FRAME_CONTENT_METADATA) ? FRAME_METADATA_SIZE : 0;
+    if (size != frameSize) {
+        return false;
+    }
+
+    size_t offset = 0;
+    if (content & FRAME_CONTENT_DEPTH) {
+        addPlane(offset, width, height, 1);
+        offset += plane * 2;
+    }
+    if (content & FRAME_CONTENT_AB) {
+        addPlane(offset, width, height, 1);
+        offset += plane * 2;
+    }
+    if (content & FRAME_CONTENT_CONF) {
+        addPlane(offset, wide, height, 2);
+        offset += plane * 4;
+    }
+    if (content & FRAME_CONTENT_METADATA) {
+        addPlane(offset, FRAME_METADATA_SIZE / sizeof(uint16_t), 1, 1);
+    }
+    return true;
+}
+
+aditof::Status FrameCodec::configure(uint16_t layout, uint16_t width,
+                                     uint16_t height, uint16_t planeCount,
+                                     size_t frameSize) {
+    m_segments.clear();
+    m_slots.clear();
+    m_frameSize = 0;
+    m_maxEncodedSize = 0;
+
+    if (frameSize == 0 || frameSize % sizeof(uint16_t) ||
+        frameSize > UINT32_MAX) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    const size_t plane = static_cast<size_t>(width) * height;
+    const size_t wide = 2 * static_cast<size_t>(width);
+    if ((layout & FRAME_LAYOUT_SELECTED) &&
+        addSelectedPlanes(layout, width, height, frameSize)) {
+        // Only the planes the client asked for
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB_CONF && wide <= UINT16_MAX &&
+               frameSize == plane * 8) {
+        addPlane(0, width, height, 1);
+        addPlane(plane * 2, width, height, 1);
+        addPlane(plane * 4, wide, height, 2);
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB && width &&
+               frameSize == plane * 4) {
+        addPlane(0, width, height, 1);
+        addPlane(plane * 2, width, height, 1);
+    } else if (layout == FRAME_LAYOUT_PCM && width &&
+               frameSize == plane * 2 * planeCount) {
+        for (size_t p = 0; p < planeCount; ++p) {
+            addPlane(p * plane * 2, width, height, 1);
+        }
+    } else {
+        const size_t values = frameSize / sizeof(uint16_t);
+        const size_t rows = values / DEFAULT_WIDTH;
+        addPlane(0, DEFAULT_WIDTH, rows, 1);
+        if (values % DEFAULT_WIDTH) {
+            addPlane(rows * DEFAULT_WIDTH * sizeof(uint16_t),
+                     values % DEFAULT_WIDTH, 1, 1);
+        }
+    }
+
+    if (m_segments.size() > UINT16_MAX) {
+        m_segments.clear();
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    size_t offset = sizeof(FrameCodecHeader) +
+                    m_segments.size() * sizeof(FrameCodecSegment);
+    for (const auto &segment : m_segments) {
+        m_slots.push_back(offset);
+        offset += max_band_size(segment.rawBytes / sizeof(uint16_t));
+    }
+    m_frameSize = frameSize;
+    m_maxEncodedSize = offset;
+    return aditof::Status::OK;
+}
+
+void FrameCodec::encodeSegment(const uint8_t *frame, size_t index,
+                               uint8_t *out) {
+    thread_local std::vector<uint16_t> residuals;
+
+    FrameCodecSegment &segment = m_segments[index];
+    const size_t count = segment.rawBytes / sizeof(uint16_t);
+    const size_t rows = count / segment.width;
+    residuals.resize(count);
+
+    predict(reinterpret_cast<const uint16_t *>(frame + segment.rawOffset),
+            segment.width, rows, segment.lanes, residuals.data());
+    segment.encodedBytes = static_cast<uint32_t>(
+        pack(residuals.data(), count, out + m_slots[index]));
+}
+
+size_t FrameCodec::finish(uint8_t *out) {
+    size_t offset = sizeof(FrameCodecHeader) +
+                    m_segments.size() * sizeof(FrameCodecSegment);
+    for (size_t i = 0; i < m_segments.size(); ++i) {
+        // Bands only move towards the start, each one after the previous
+        if (offset != m_slots[i]) {
+            memmove(out + offset, out + m_slots[i],
+                    m_segments[i].encodedBytes);
+        }
+        offset += m_segments[i].encodedBytes;
+    }
+
+    FrameCodecHeader header = {};
+    header.magic = FRAME_CODEC_MAGIC;
+    header.version = FRAME_CODEC_VERSION;
+    header.segmentCount = static_cast<uint16_t>(m_segments.size());
+    header.rawSize = static_cast<uint32_t>(m_frameSize);
+    header.encodedSize = static_cast<uint32_t>(offset);
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), m_segments.data(),
+           m_segments.size() * sizeof(FrameCodecSegment));
+
+    return offset;
+}
+
+aditof::Status FrameCodec::decode(const uint8_t *data, size_t size,
+                                  uint8_t *frame, size_t frameSize) {
+    FrameCodecHeader header;
+    if (size < sizeof(header)) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    memcpy(&header, data, sizeof(header));
+    const size_t tableEnd =
+        sizeof(header) + header.segmentCount * sizeof(FrameCodecSegment);
+    if (header.magic != FRAME_CODEC_MAGIC ||
+        header.version != FRAME_CODEC_VERSION || header.encodedSize != size ||
+        header.rawSize > frameSize || tableEnd > size) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    std::vector<uint16_t> residuals;
+    std::vector<uint16_t> values; // frame may not be 16-bit aligned
+    size_t offset = tableEnd;
+    for (size_t i = 0; i < header.segmentCount; ++i) {
+        FrameCodecSegment segment;
+        memcpy(&segment, data + sizeof(header) + i * sizeof(segment),
+               sizeof(segment));
+
+        const size_t count = segment.rawBytes / sizeof(uint16_t);
+        if (!segment.width || count % segment.width ||
+            segment.rawOffset + static_cast<size_t>(segment.rawBytes) >
+                header.rawSize ||
+            segment.encodedBytes > size - offset) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+
+        residuals.resize(count);
+        if (!unpack(data + offset, segment.encodedBytes, count,
+                    residuals.data())) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+        values.resize(count);
+        reconstruct(residuals.data(), segment.width, count / segment.width,
+                    segment.lanes, values.data());
+        memcpy(frame + segment.rawOffset, values.data(), segment.rawBytes);
+
+        offset += segment.encodedBytes;
+    }
+    return aditof::Status::OK;
+}
@@ -0,0 +1,128 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_CODEC_H
+#define FRAME_CODEC_H
+
+#include <aditof/status_definitions.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Lossless compression of frames for the stream socket.
+ *
+ * The 16-bit values of each plane are predicted from their left neighbour
+ * (from the value above at the start of a row), the residuals are zigzag
+ * coded and stored in blocks of 128 with the number of bits the largest one
+ * needs. Depth and AB are smooth, so most blocks take 4 to 8 bits per pixel
+ * and empty planes next to nothing.
+ *
+ * Planes are cut in bands of rows coded independently, so a frame can be
+ * encoded by several threads. The encoded frame is a FrameCodecHeader, a
+ * FrameCodecSegment per band and the bands one after the other. All fields
+ * are little-endian.
+ */
+struct FrameCodecHeader {
+    uint32_t magic;        // FRAME_CODEC_MAGIC
+    uint16_t version;      // FRAME_CODEC_VERSION
+    uint16_t segmentCount; // FrameCodecSegment entries that follow
+    uint32_t rawSize;      // bytes of the decoded frame
+    uint32_t encodedSize;  // bytes of the encoded frame, this header included
+};
+
+struct FrameCodecSegment {
+    uint32_t rawOffset;    // where the band starts in the decoded frame
+    uint32_t rawBytes;     // size of the band in the decoded frame
+    uint16_t width;        // 16-bit values per row
+    uint16_t lanes;        // interleaved channels in a row (2 for 32-bit data)
+    uint32_t encodedBytes; // size of the band in the encoded frame
+};
+
+static_assert(sizeof(FrameCodecHeader) == 16, "FrameCodecHeader is part of "
+                                              "the wire protocol");
+static_assert(sizeof(FrameCodecSegment) == 16, "FrameCodecSegment is part of "
+                                               "the wire protocol");
+
+static const uint32_t FRAME_CODEC_MAGIC = 0x43464441; // "ADFC"
+static const uint16_t FRAME_CODEC_VERSION = 1;
+
+class FrameCodec {
+  public:
+    /**
+     * @brief Cuts frames of frameSize bytes laid out as given (FrameLayout,
+     * including FRAME_LAYOUT_SELECTED payloads) in bands. Frames that don't
+     * match the layout are coded as rows of 16-bit values.
+     */
+    aditof::Status configure(uint16_t layout, uint16_t width, uint16_t height,
+                             uint16_t planeCount, size_t frameSize);
+
+    size_t frameSize() const { return m_frameSize; }
+    size_t segmentCount() const { return m_segments.size(); }
+
+    /**
+     * @brief Size of the buffer encodeSegment() and finish() work in.
+     */
+    size_t maxEncodedSize() const { return m_maxEncodedSize; }
+
+    /**
+     * @brief Encodes band index of frame into out. Different bands can be
+     * encoded at the same time by different threads.
+     */
+    void encodeSegment(const uint8_t *frame, size_t index, uint8_t *out);
+
+    /**
+     * @brief Writes the header and packs the encoded bands once all of them
+     * are done.
+     * @return The size of the encoded frame.
+     */
+    size_t finish(uint8_t *out);
+
+    /**
+     * @brief Decodes an encoded frame into frame, which has room for
+     * frameSize bytes.
+     */
+    static aditof::Status decode(const uint8_t *data, size_t size,
+                                 uint8_t *frame, size_t frameSize);
+
+  private:
+    void addPlane(size_t offset, size_t width, size_t height, size_t lanes);
+    bool addSelectedPlanes(uint16_t content, size_t width, size_t height,
+                           size_t frameSize);
+
+    std::vector<FrameCodecSegment> m_segments;
+    std::vector<size_t> m_slots; // where each band is encoded in out
+    size_t m_frameSize = 0;
+    size_t m_maxEncodedSize = 0;
+};
+
+#endif // FRAME_CODEC_H
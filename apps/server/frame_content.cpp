@@ -0,0 +1,102 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_content.h"
+#include "frame_header.h"
+
+#include <cstring>
+
+bool describeFrameContent(uint16_t layout, uint16_t width, uint16_t height,
+                          uint16_t planeCount, size_t length, uint16_t content,
+                          SentFrame &sent) {
+    sent = SentFrame();
+    sent.layout = layout;
+    sent.planeCount = planeCount;
+    sent.width = width;
+    sent.height = height;
+    sent.length = length;
+
+    const size_t plane = static_cast<size_t>(width) * height;
+    uint16_t available = 0;
+    if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+        available = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+                    FRAME_CONTENT_CONF | FRAME_CONTENT_METADATA;
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB) {
+        available =
+            FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB | FRAME_CONTENT_METADATA;
+    }
+
+    const uint16_t selected = content & available;
+    const uint16_t whole = available & ~FRAME_CONTENT_METADATA;
+    if (!selected || selected == whole || plane * 2 < FRAME_METADATA_SIZE) {
+        return !content || selected;
+    }
+
+    // In payload order, see FrameContent
+    const FrameSlice planes[] = {{0, plane * 2},
+                                 {plane * 2, plane * 2},
+                                 {plane * 4, plane * 4},
+                                 {plane * 2, FRAME_METADATA_SIZE}};
+    sent.layout = FRAME_LAYOUT_SELECTED | selected;
+    sent.planeCount = 0;
+    sent.length = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        if (!(selected & (1u << i))) {
+            continue;
+        }
+        const FrameSlice &slice = planes[i];
+        if (!sent.slices.empty() &&
+            sent.slices.back().offset + sent.slices.back().length ==
+                slice.offset) {
+            sent.slices.back().length += slice.length;
+        } else {
+            sent.slices.push_back(slice);
+        }
+        sent.length += slice.length;
+        if (i < 3) {
+            ++sent.planeCount;
+        }
+    }
+
+    return true;
+}
+
+void gatherFrameContent(const SentFrame &sent, const uint8_t *frame,
+                        uint8_t *out) {
+    if (sent.slices.empty()) {
+        memcpy(out, frame, sent.length);
+        return;
+    }
+    for (const FrameSlice &slice : sent.slices) {
+        memcpy(out, frame + slice.offset, slice.length);
+        out += slice.length;
+    }
+}
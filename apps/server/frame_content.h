@@ -0,0 +1,80 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_CONTENT_H
+#define FRAME_CONTENT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Bytes of a frame that are sent as one piece.
+ */
+struct FrameSlice {
+    size_t offset;
+    size_t length;
+};
+
+/**
+ * @brief What is sent of each frame of a mode. The layout is a FrameLayout,
+ * FRAME_LAYOUT_SELECTED ORed with the FrameContent bits when only some
+ * planes are sent, in which case slices tells where they are in the frame.
+ */
+struct SentFrame {
+    uint16_t layout = 0;
+    uint16_t planeCount = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    size_t length = 0;
+    std::vector<FrameSlice> slices; // empty for the whole frame
+};
+
+/**
+ * @brief Works out what is sent of frames of the given layout (FrameLayout),
+ * resolution and length when only the planes in content (FrameContent bits,
+ * 0 for everything) are wanted. Layouts without separate planes are sent
+ * whole.
+ * @return false if none of the planes in content exist in this layout, sent
+ * then describes whole frames.
+ */
+bool describeFrameContent(uint16_t layout, uint16_t width, uint16_t height,
+                          uint16_t planeCount, size_t length, uint16_t content,
+                          SentFrame &sent);
+
+/**
+ * @brief Copies the slices of sent out of frame, one after the other, to out
+ * which must hold sent.length bytes.
+ */
+void gatherFrameContent(const SentFrame &sent, const uint8_t *frame,
+                        uint8_t *out);
+
+#endif // FRAME_CONTENT_H
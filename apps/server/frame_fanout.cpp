@@ -0,0 +1,411 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_fanout.h"
+#include "frame_content.h"
+#include "frame_header.h"
+
+#include <aditof/log.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <string>
+#include <thread>
+
+namespace {
+
+// Frames ZMQ queues for a subscriber on top of its ring
+const int SUBSCRIBER_SNDHWM = 2;
+
+int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+} // namespace
+
+class FrameFanout::Subscriber {
+  public:
+    Subscriber(uint32_t id, uint16_t port, const SubscriberOptions &options)
+        : m_id(id), m_port(port), m_options(options),
+          m_ring(options.queueDepth, options.dropPolicy) {}
+
+    ~Subscriber() { stop(); }
+
+    aditof::Status start(zmq::context_t &context,
+                         std::shared_ptr<const FanoutStream> stream) {
+        try {
+            m_socket = std::make_unique<zmq::socket_t>(
+                context, zmq::socket_type::push);
+            m_socket->set(zmq::sockopt::sndhwm, SUBSCRIBER_SNDHWM);
+            m_socket->set(zmq::sockopt::linger, 0);
+            m_socket->bind("tcp://*:" + std::to_string(m_port));
+        } catch (const zmq::error_t &e) {
+            LOG(ERROR) << "Failed to bind subscriber socket on port "
+                       << m_port << ": " << e.what();
+            m_socket.reset();
+            return aditof::Status::GENERIC_ERROR;
+        }
+
+        m_stream = std::move(stream);
+        m_lastSent = std::chrono::steady_clock::now();
+        m_thread = std::thread(&Subscriber::run, this);
+
+        return aditof::Status::OK;
+    }
+
+    void stop() {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stop = true;
+        }
+        m_cv.notify_one();
+        if (m_thread.joinable()) {
+            m_thread.join();
+        }
+
+        while (FramePool::Buffer *frame = m_ring.pop()) {
+            frame->pool->release(frame);
+        }
+        m_socket.reset();
+    }
+
+    void setStream(std::shared_ptr<const FanoutStream> stream) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stream = std::move(stream);
+    }
+
+    void offer(FramePool::Buffer *frame) {
+        frame->pool->retain(frame);
+        FramePool::Buffer *dropped = m_ring.push(frame);
+        if (dropped) {
+            dropped->pool->release(dropped);
+        }
+        { std::lock_guard<std::mutex> lock(m_mutex); }
+        m_cv.notify_one();
+    }
+
+    uint32_t id() const { return m_id; }
+    bool expired() const { return m_expired.load(); }
+
+    SubscriberStats stats() const {
+        SubscriberStats stats;
+        stats.id = m_id;
+        stats.port = m_port;
+        stats.framesSent = m_framesSent.load();
+        stats.bytesSent = m_bytesSent.load();
+        stats.framesDropped = m_framesDropped.load() +
+                              m_ring.droppedOldest() + m_ring.droppedNewest();
+        return stats;
+    }
+
+  private:
+    void run() {
+        std::shared_ptr<const FanoutStream> configured;
+        while (true) {
+            std::shared_ptr<const FanoutStream> stream;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_cv.wait_for(lock, std::chrono::milliseconds(100), [this] {
+                    return m_stop || !m_ring.empty();
+                });
+                if (m_stop) {
+                    break;
+                }
+                stream = m_stream;
+            }
+
+            FramePool::Buffer *frame = m_ring.pop();
+            if (!frame) {
+                continue;
+            }
+            if (!stream || frame->generation != stream->generation) {
+                // Captured before a mode switch
+                frame->pool->release(frame);
+                ++m_framesDropped;
+                continue;
+            }
+
+            if (stream != configured) {
+                configure(*stream);
+                configured = stream;
+            }
+            if (!send(frame, *stream)) {
+                LOG(INFO) << "Subscriber " << m_id << " took no frame for "
+                          << SUBSCRIBER_IDLE_TIMEOUT_MS << " ms, dropping it";
+                m_expired = true;
+                break;
+            }
+        }
+    }
+
+    // Works out what is sent of the frames of stream
+    void configure(const FanoutStream &stream) {
+        uint16_t width = stream.width;
+        uint16_t height = stream.height;
+        size_t length = stream.frameSize;
+
+        m_transformEnabled = false;
+        const FrameRegion &region = m_options.region;
+        if (region.width || region.decimation != 1) {
+            if (m_transform.configure(stream.layout, stream.width,
+                                      stream.height, stream.planeCount,
+                                      region) == aditof::Status::OK) {
+                m_transformEnabled = true;
+                m_transformed.resize(m_transform.outputSize());
+                width = m_transform.outputWidth();
+                height = m_transform.outputHeight();
+                length = m_transform.outputSize();
+            } else {
+                LOG(WARNING) << "Region of subscriber " << m_id
+                             << " does not fit this mode, sending whole "
+                                "frames";
+            }
+        }
+
+        if (!describeFrameContent(stream.layout, width, height,
+                                  stream.planeCount, length, m_options.content,
+                                  m_sent)) {
+            LOG(WARNING) << "Planes of subscriber " << m_id
+                         << " are not available in this mode, sending "
+                            "whole frames";
+        }
+    }
+
+    // Copies what the subscriber wants out of frame, releases it and sends
+    // the copy. Returns false once the subscriber has been idle too long.
+    bool send(FramePool::Buffer *frame, const FanoutStream &stream) {
+        const uint8_t *data = frame->data;
+        if (m_transformEnabled) {
+            for (size_t i = 0; i < m_transform.bandCount(); ++i) {
+                m_transform.apply(frame->data, m_transformed.data(), i);
+            }
+            m_transform.finish(frame->data, m_transformed.data());
+            data = m_transformed.data();
+        }
+        zmq::message_t payload(m_sent.length);
+        gatherFrameContent(m_sent, data,
+                           static_cast<uint8_t *>(payload.data()));
+
+        FrameHeader header = {};
+        header.magic = FRAME_HEADER_MAGIC;
+        header.version = FRAME_HEADER_VERSION;
+        header.headerSize = sizeof(FrameHeader);
+        header.sequence = m_sequence++;
+        header.captureIndex = frame->captureIndex;
+        header.captureTimestamp = frame->captureTimestamp;
+        header.enqueueTimestamp = wall_clock_ns();
+        header.payloadSize = static_cast<uint32_t>(m_sent.length);
+        header.modeNumber = stream.modeNumber;
+        header.payloadLayout = m_sent.layout;
+        header.width = m_sent.width;
+        header.height = m_sent.height;
+        header.planeCount = m_sent.planeCount;
+        header.encoding = FRAME_ENCODING_RAW;
+        frame->pool->release(frame);
+
+        // Once the header is queued the payload can't be refused
+        header.sendTimestamp = wall_clock_ns();
+        zmq::message_t headerMessage(&header, sizeof(header));
+        auto now = std::chrono::steady_clock::now();
+        if (m_socket->send(headerMessage, zmq::send_flags::sndmore |
+                                              zmq::send_flags::dontwait) &&
+            m_socket->send(payload, zmq::send_flags::dontwait)) {
+            ++m_framesSent;
+            m_bytesSent += sizeof(header) + m_sent.length;
+            m_lastSent = now;
+            return true;
+        }
+
+        ++m_framesDropped;
+        return now - m_lastSent <
+               std::chrono::milliseconds(SUBSCRIBER_IDLE_TIMEOUT_MS);
+    }
+
+    const uint32_t m_id;
+    const uint16_t m_port;
+    const SubscriberOptions m_options;
+
+    FrameRing<FramePool::Buffer> m_ring;
+    std::unique_ptr<zmq::socket_t> m_socket;
+    std::thread m_thread;
+
+    // Guards m_stop and m_stream, m_cv wakes the thread up
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    bool m_stop = false;
+    std::shared_ptr<const FanoutStream> m_stream;
+    std::atomic<bool> m_expired{false};
+
+    // Used by the thread only
+    FrameTransform m_transform;
+    bool m_transformEnabled = false;
+    std::vector<uint8_t> m_transformed;
+    SentFrame m_sent;
+    uint64_t m_sequence = 0;
+    std::chrono::steady_clock::time_point m_lastSent;
+
+    std::atomic<uint64_t> m_framesSent{0};
+    std::atomic<uint64_t> m_bytesSent{0};
+    std::atomic<uint64_t> m_framesDropped{0};
+};
+
+FrameFanout::FrameFanout() = default;
+
+FrameFanout::~FrameFanout() { shutdown(); }
+
+void FrameFanout::configure(zmq::context_t &context, size_t maxSubscribers,
+                            uint16_t basePort) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_context = &context;
+    m_slots.resize(maxSubscribers);
+    m_basePort = basePort;
+}
+
+void FrameFanout::setStream(const FanoutStream &stream) {
+    auto shared = std::make_shared<const FanoutStream>(stream);
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stream = shared;
+    for (auto &subscriber : m_slots) {
+        if (subscriber) {
+            subscriber->setStream(shared);
+        }
+    }
+}
+
+aditof::Status FrameFanout::subscribe(const SubscriberOptions &options,
+                                      uint32_t &id, uint16_t &port) {
+    if (options.queueDepth < 1 || options.queueDepth > MAX_QUEUE_DEPTH) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reapIdle();
+    for (size_t i = 0; i < m_slots.size(); ++i) {
+        if (m_slots[i]) {
+            continue;
+        }
+
+        const uint16_t slotPort = static_cast<uint16_t>(m_basePort + i);
+        std::unique_ptr<Subscriber> subscriber(
+            new Subscriber(m_nextId, slotPort, options));
+        aditof::Status status = subscriber->start(*m_context, m_stream);
+        if (status != aditof::Status::OK) {
+            return status;
+        }
+
+        id = m_nextId++;
+        port = slotPort;
+        m_slots[i] = std::move(subscriber);
+        LOG(INFO) << "Subscriber " << id << " streaming on port " << port;
+        return aditof::Status::OK;
+    }
+
+    return aditof::Status::BUSY;
+}
+
+aditof::Status FrameFanout::unsubscribe(uint32_t id) {
+    std::unique_ptr<Subscriber> subscriber;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &slot : m_slots) {
+            if (slot && slot->id() == id) {
+                subscriber = std::move(slot);
+                break;
+            }
+        }
+    }
+    if (!subscriber) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    // Stopped outside the lock so that the capture thread is not held up
+    subscriber.reset();
+    LOG(INFO) << "Subscriber " << id << " removed";
+
+    return aditof::Status::OK;
+}
+
+void FrameFanout::offer(FramePool::Buffer *frame) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reapIdle();
+    for (auto &subscriber : m_slots) {
+        if (subscriber && !subscriber->expired()) {
+            subscriber->offer(frame);
+        }
+    }
+}
+
+size_t FrameFanout::subscriberCount() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    size_t count = 0;
+    for (const auto &subscriber : m_slots) {
+        if (subscriber && !subscriber->expired()) {
+            ++count;
+        }
+    }
+    return count;
+}
+
+std::vector<SubscriberStats> FrameFanout::stats() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    reapIdle();
+    std::vector<SubscriberStats> stats;
+    for (const auto &subscriber : m_slots) {
+        if (subscriber) {
+            stats.push_back(subscriber->stats());
+        }
+    }
+    return stats;
+}
+
+void FrameFanout::shutdown() {
+    std::vector<std::unique_ptr<Subscriber>> subscribers;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        for (auto &slot : m_slots) {
+            subscribers.push_back(std::move(slot));
+        }
+    }
+    subscribers.clear();
+}
+
+// Frees the slots of subscribers whose thread gave up on them. Their thread
+// has already returned, so this doesn't wait. Called with m_mutex held.
+void FrameFanout::reapIdle() {
+    for (auto &slot : m_slots) {
+        if (slot && slot->expired()) {
+            slot.reset();
+        }
+    }
+}
@@ -0,0 +1,168 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_FANOUT_H
+#define FRAME_FANOUT_H
+
+#include "frame_pool.h"
+#include "frame_ring.h"
+#include "frame_transform.h"
+
+#include <aditof/status_definitions.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include <zmq.hpp>
+
+/**
+ * @brief Frames of the current mode, as they come out of the capture thread.
+ */
+struct FanoutStream {
+    uint32_t generation = 0; // FramePool generation of the captured frames
+    uint16_t modeNumber = 0;
+    uint16_t layout = 0; // FrameLayout
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t planeCount = 0;
+    size_t frameSize = 0;
+};
+
+/**
+ * @brief What a subscriber wants of the stream.
+ */
+struct SubscriberOptions {
+    uint16_t content = 0;  // FrameContent bits, 0 for whole frames
+    FrameRegion region;    // whole image if width is 0 and decimation 1
+    size_t queueDepth = 2; // frames that can wait for the subscriber
+    DropPolicy dropPolicy = DropPolicy::DROP_OLDEST;
+};
+
+/**
+ * @brief Counters of one subscriber.
+ */
+struct SubscriberStats {
+    uint32_t id = 0;
+    uint16_t port = 0;
+    uint64_t framesSent = 0;
+    uint64_t bytesSent = 0;
+    uint64_t framesDropped = 0; // by its queue or because it was busy
+};
+
+/**
+ * @brief Shares the frames of one capture with clients that only watch the
+ * stream, the subscribers.
+ *
+ * The capture thread offers each frame once. Every subscriber takes a
+ * reference to it in its own ring, with its own depth and drop policy, and
+ * has a thread that crops and selects what it asked for into a message sent
+ * on its own PUSH socket, always after the frame header. The capture buffer
+ * is released as soon as it has been copied. A subscriber that takes no
+ * frame for SUBSCRIBER_IDLE_TIMEOUT_MS while frames are flowing is dropped.
+ */
+class FrameFanout {
+  public:
+    static const size_t MAX_QUEUE_DEPTH = 4;
+    static const int SUBSCRIBER_IDLE_TIMEOUT_MS = 10000;
+
+    FrameFanout();
+    ~FrameFanout();
+
+    FrameFanout(const FrameFanout &) = delete;
+    FrameFanout &operator=(const FrameFanout &) = delete;
+
+    /**
+     * @brief Allows up to maxSubscribers, the one in slot i sending on port
+     * basePort + i. Must be called before anything else.
+     */
+    void configure(zmq::context_t &context, size_t maxSubscribers,
+                   uint16_t basePort);
+
+    size_t maxSubscribers() const { return m_slots.size(); }
+
+    /**
+     * @brief Capture buffers the subscribers can hold at the same time,
+     * which the frame pool needs on top of its own.
+     */
+    size_t bufferBudget() const {
+        return m_slots.size() * (MAX_QUEUE_DEPTH + 1);
+    }
+
+    /**
+     * @brief Describes the frames offered from now on. Frames of an older
+     * pool generation still queued are dropped.
+     */
+    void setStream(const FanoutStream &stream);
+
+    /**
+     * @brief Adds a subscriber and starts its thread.
+     * @return BUSY if all slots are taken, GENERIC_ERROR if its port can't
+     * be bound.
+     */
+    aditof::Status subscribe(const SubscriberOptions &options, uint32_t &id,
+                             uint16_t &port);
+
+    /**
+     * @brief Stops the subscriber with the given id.
+     * @return INVALID_ARGUMENT if there is no such subscriber.
+     */
+    aditof::Status unsubscribe(uint32_t id);
+
+    /**
+     * @brief Capture thread side. Queues a reference to frame for every
+     * subscriber, after freeing the slots of those that were dropped.
+     */
+    void offer(FramePool::Buffer *frame);
+
+    size_t subscriberCount() const;
+    std::vector<SubscriberStats> stats();
+
+    /**
+     * @brief Stops all subscribers and closes their sockets.
+     */
+    void shutdown();
+
+  private:
+    class Subscriber;
+
+    void reapIdle();
+
+    mutable std::mutex m_mutex;
+    std::vector<std::unique_ptr<Subscriber>> m_slots;
+    std::shared_ptr<const FanoutStream> m_stream;
+    zmq::context_t *m_context = nullptr;
+    uint16_t m_basePort = 0;
+    uint32_t m_nextId = 1;
+};
+
+#endif // FRAME_FANOUT_H
@@ -0,0 +1,113 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_HEADER_H
+#define FRAME_HEADER_H
+
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Optional header sent as the first part of a two-part message in
+ * front of every frame on the stream socket (enabled with SetFrameHeader).
+ *
+ * All fields are little-endian. Timestamps are CLOCK_REALTIME nanoseconds so
+ * a host with a synchronized clock can compute capture-to-display latency.
+ * Clients should use headerSize to find the payload description fields of
+ * newer versions and skip what they don't know.
+ *
+ * captureIndex is the frame number the ADSD3500 writes in the metadata,
+ * carried on past 32 bits, so a gap is a frame the sensor, the driver or the
+ * server dropped. Frames without metadata (PCM modes) are numbered by the
+ * server in the order they were read.
+ */
+struct FrameHeader {
+    uint32_t magic;            // FRAME_HEADER_MAGIC
+    uint16_t version;          // FRAME_HEADER_VERSION
+    uint16_t headerSize;       // sizeof(FrameHeader) on the server
+    uint64_t sequence;         // frames the server tried to send since Start
+    uint64_t captureIndex;     // frame number of the sensor, see above
+    int64_t captureTimestamp;  // when the frame came out of getFrame()
+    int64_t enqueueTimestamp;  // when it was processed and queued to send
+    int64_t sendTimestamp;     // when the frame was handed to the socket
+    uint32_t payloadSize;      // bytes in the message part that follows
+    uint16_t modeNumber;       // mode the frame was captured in
+    uint16_t payloadLayout;    // one of FrameLayout
+    uint16_t width;            // of the payload, cropped and decimated
+    uint16_t height;
+    uint16_t planeCount;       // planes of width x height in the payload
+    uint16_t encoding;         // one of FrameEncoding
+};
+
+static_assert(sizeof(FrameHeader) == 64, "FrameHeader is part of the wire "
+                                         "protocol, its size must not change");
+
+static const uint32_t FRAME_HEADER_MAGIC = 0x48464441; // "ADFH"
+static const uint16_t FRAME_HEADER_VERSION = 1;
+
+/**
+ * @brief How the planes of a frame are laid out in the payload.
+ */
+enum FrameLayout : uint16_t {
+    FRAME_LAYOUT_DEPTH_AB_CONF = 0, // 16-bit depth, 16-bit AB, 32-bit conf
+    FRAME_LAYOUT_DEPTH_AB = 1,      // 16-bit depth, 16-bit AB
+    FRAME_LAYOUT_PCM = 2,           // planeCount 16-bit phase planes
+    FRAME_LAYOUT_SELECTED = 0x100,  // ORed with FrameContent bits: only the
+                                    // planes chosen with SetFrameContent
+};
+
+/**
+ * @brief Planes of a FRAME_LAYOUT_SELECTED payload. They follow each other
+ * in this order: 16-bit depth, 16-bit AB, 32-bit conf and the 128-byte
+ * metadata block found at the start of the AB plane.
+ */
+enum FrameContent : uint16_t {
+    FRAME_CONTENT_DEPTH = 0x01,
+    FRAME_CONTENT_AB = 0x02,
+    FRAME_CONTENT_CONF = 0x04,
+    FRAME_CONTENT_METADATA = 0x08,
+};
+
+static const size_t FRAME_METADATA_SIZE = 128;
+static const size_t FRAME_METADATA_FRAME_NUMBER = 12; // offset of the 32-bit
+                                                      // frame number
+
+/**
+ * @brief How the payload is encoded on the wire.
+ */
+enum FrameEncoding : uint16_t {
+    FRAME_ENCODING_RAW = 0,        // planes as described by payloadLayout
+    FRAME_ENCODING_DELTA_PACK = 1, // the planes compressed by FrameCodec
+    FRAME_ENCODING_PACK12 = 2,     // some planes 12-bit packed by FramePacker
+    FRAME_ENCODING_TILE_DELTA = 3, // the tiles that changed, see tile_delta.h
+};
+
+#endif // FRAME_HEADER_H
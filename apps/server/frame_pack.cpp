@@ -0,0 +1,323 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_pack.h"
+#include "frame_header.h"
+
+#include <algorithm>
+#include <cstring>
+
+// FRAME_PACK_SCALAR leaves out the SIMD kernels, e.g. to test the others
+// against the scalar code
+#if defined(FRAME_PACK_SCALAR)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FRAME_PACK_NEON
+#elif defined(__SSSE3__)
+#include <tmmintrin.h>
+#define FRAME_PACK_SSSE3
+#endif
+
+namespace {
+
+const uint16_t MAX_VALUE = 0xfff;
+
+size_t packed_bytes(size_t count) { return count / 2 * 3 + (count % 2) * 2; }
+
+// Packs four values in 6 bytes
+inline void pack4(const uint16_t *in, uint8_t *out) {
+    uint64_t packed = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        packed |= static_cast<uint64_t>(std::min(in[i], MAX_VALUE)) << (12 * i);
+    }
+    for (size_t i = 0; i < 6; ++i) {
+        out[i] = static_cast<uint8_t>(packed >> (8 * i));
+    }
+}
+
+inline void unpack4(const uint8_t *in, uint16_t *out) {
+    uint64_t packed = 0;
+    for (size_t i = 0; i < 6; ++i) {
+        packed |= static_cast<uint64_t>(in[i]) << (8 * i);
+    }
+    for (size_t i = 0; i < 4; ++i) {
+        out[i] = static_cast<uint16_t>((packed >> (12 * i)) & MAX_VALUE);
+    }
+}
+
+void pack12(const uint16_t *in, size_t count, uint8_t *out) {
+    size_t i = 0;
+#if defined(FRAME_PACK_NEON)
+    const uint16x8_t max = vdupq_n_u16(MAX_VALUE);
+    for (; i + 16 <= count; i += 16) {
+        uint16x8x2_t v = vld2q_u16(in + i);
+        uint16x8_t even = vminq_u16(v.val[0], max);
+        uint16x8_t odd = vminq_u16(v.val[1], max);
+        uint8x8x3_t bytes;
+        bytes.val[0] = vmovn_u16(even);
+        bytes.val[1] =
+            vmovn_u16(vorrq_u16(vshrq_n_u16(even, 8), vshlq_n_u16(odd, 4)));
+        bytes.val[2] = vshrn_n_u16(odd, 4);
+        vst3_u8(out + i / 2 * 3, bytes);
+    }
+#elif defined(FRAME_PACK_SSSE3)
+    const __m128i excess = _mm_set1_epi16(MAX_VALUE);
+    const __m128i low = _mm_set1_epi32(0xffff);
+    const __m128i gather =
+        _mm_setr_epi8(0, 1, 2, 4, 5, 6, 8, 9, 10, 12, 13, 14, -1, -1, -1, -1);
+    for (; i + 8 <= count; i += 8) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(in + i));
+        v = _mm_sub_epi16(v, _mm_subs_epu16(v, excess));
+        // A pair of values in the low 24 bits of each 32-bit lane
+        __m128i pairs = _mm_or_si128(
+            _mm_and_si128(v, low), _mm_slli_epi32(_mm_srli_epi32(v, 16), 12));
+        pairs = _mm_shuffle_epi8(pairs, gather);
+        uint8_t *dst = out + i / 2 * 3;
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(dst), pairs);
+        int32_t tail = _mm_cvtsi128_si32(_mm_srli_si128(pairs, 8));
+        memcpy(dst + 8, &tail, sizeof(tail));
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        pack4(in + i, out + i / 2 * 3);
+    }
+    for (; i + 2 <= count; i += 2) {
+        uint16_t v0 = std::min(in[i], MAX_VALUE);
+        uint16_t v1 = std::min(in[i + 1], MAX_VALUE);
+        uint8_t *dst = out + i / 2 * 3;
+        dst[0] = static_cast<uint8_t>(v0);
+        dst[1] = static_cast<uint8_t>((v0 >> 8) | (v1 << 4));
+        dst[2] = static_cast<uint8_t>(v1 >> 4);
+    }
+    if (i < count) {
+        uint16_t v = std::min(in[i], MAX_VALUE);
+        out[i / 2 * 3] = static_cast<uint8_t>(v);
+        out[i / 2 * 3 + 1] = static_cast<uint8_t>(v >> 8);
+    }
+}
+
+void unpack12(const uint8_t *in, size_t count, uint16_t *out) {
+    size_t i = 0;
+#if defined(FRAME_PACK_NEON)
+    const uint16x8_t nibble = vdupq_n_u16(0xf);
+    for (; i + 16 <= count; i += 16) {
+        uint8x8x3_t bytes = vld3_u8(in + i / 2 * 3);
+        uint16x8_t b0 = vmovl_u8(bytes.val[0]);
+        uint16x8_t b1 = vmovl_u8(bytes.val[1]);
+        uint16x8_t b2 = vmovl_u8(bytes.val[2]);
+        uint16x8x2_t v;
+        v.val[0] = vorrq_u16(b0, vshlq_n_u16(vandq_u16(b1, nibble), 8));
+        v.val[1] = vorrq_u16(vshrq_n_u16(b1, 4), vshlq_n_u16(b2, 4));
+        vst2q_u16(out + i, v);
+    }
+#elif defined(FRAME_PACK_SSSE3)
+    const __m128i value = _mm_set1_epi32(MAX_VALUE);
+    const __m128i spread =
+        _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1, 6, 7, 8, -1, 9, 10, 11, -1);
+    for (; i + 8 <= count; i += 8) {
+        const uint8_t *src = in + i / 2 * 3;
+        int32_t tail;
+        memcpy(&tail, src + 8, sizeof(tail));
+        __m128i pairs = _mm_unpacklo_epi64(
+            _mm_loadl_epi64(reinterpret_cast<const __m128i *>(src)),
+            _mm_cvtsi32_si128(tail));
+        pairs = _mm_shuffle_epi8(pairs, spread);
+        __m128i v = _mm_or_si128(
+            _mm_and_si128(pairs, value),
+            _mm_slli_epi32(_mm_and_si128(_mm_srli_epi32(pairs, 12), value),
+                           16));
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), v);
+    }
+#endif
+    for (; i + 4 <= count; i += 4) {
+        unpack4(in + i / 2 * 3, out + i);
+    }
+    for (; i + 2 <= count; i += 2) {
+        const uint8_t *src = in + i / 2 * 3;
+        out[i] = static_cast<uint16_t>(src[0] | ((src[1] & 0xf) << 8));
+        out[i + 1] = static_cast<uint16_t>((src[1] >> 4) | (src[2] << 4));
+    }
+    if (i < count) {
+        const uint8_t *src = in + i / 2 * 3;
+        out[i] = static_cast<uint16_t>(src[0] | (src[1] << 8));
+    }
+}
+
+} // namespace
+
+void FramePacker::addRun(size_t offset, size_t bytes, bool packed) {
+    if (!bytes) {
+        return;
+    }
+    const uint16_t bits = packed ? 12 : 16;
+    if (!m_segments.empty() && m_segments.back().bits == bits &&
+        m_segments.back().rawOffset + m_segments.back().rawBytes == offset) {
+        m_segments.back().rawBytes += static_cast<uint32_t>(bytes);
+        return;
+    }
+    FramePackSegment segment = {};
+    segment.rawOffset = static_cast<uint32_t>(offset);
+    segment.rawBytes = static_cast<uint32_t>(bytes);
+    segment.bits = bits;
+    m_segments.push_back(segment);
+}
+
+aditof::Status FramePacker::configure(uint16_t layout, uint16_t width,
+                                      uint16_t height, size_t frameSize,
+                                      uint16_t packedContent) {
+    m_segments.clear();
+    m_frameSize = 0;
+    m_packedSize = 0;
+
+    // The planes of the frame in payload order, see FrameContent
+    const size_t plane = static_cast<size_t>(width) * height;
+    const size_t sizes[] = {plane * 2, plane * 2, plane * 4,
+                            FRAME_METADATA_SIZE};
+    uint16_t content = 0;
+    if (layout & FRAME_LAYOUT_SELECTED) {
+        content = layout & (FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+                            FRAME_CONTENT_CONF | FRAME_CONTENT_METADATA);
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+        content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB | FRAME_CONTENT_CONF;
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB) {
+        content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB;
+    }
+    packedContent &= content & (FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB);
+    if (!packedContent || plane * 2 < FRAME_METADATA_SIZE ||
+        frameSize > UINT32_MAX) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    size_t offset = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        const uint16_t bit = static_cast<uint16_t>(1u << i);
+        if (!(content & bit)) {
+            continue;
+        }
+        if (!(packedContent & bit)) {
+            addRun(offset, sizes[i], false);
+        } else if (bit == FRAME_CONTENT_AB) {
+            addRun(offset, FRAME_METADATA_SIZE, false);
+            addRun(offset + FRAME_METADATA_SIZE,
+                   sizes[i] - FRAME_METADATA_SIZE, true);
+        } else {
+            addRun(offset, sizes[i], true);
+        }
+        offset += sizes[i];
+    }
+    if (offset != frameSize || m_segments.size() > UINT16_MAX) {
+        m_segments.clear();
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    m_packedSize = sizeof(FramePackHeader) +
+                   m_segments.size() * sizeof(FramePackSegment);
+    for (const auto &segment : m_segments) {
+        m_packedSize += segment.bits == 12
+                            ? packed_bytes(segment.rawBytes / sizeof(uint16_t))
+                            : segment.rawBytes;
+    }
+    m_frameSize = frameSize;
+    return aditof::Status::OK;
+}
+
+void FramePacker::pack(const uint8_t *frame, uint8_t *out) const {
+    FramePackHeader header = {};
+    header.magic = FRAME_PACK_MAGIC;
+    header.version = FRAME_PACK_VERSION;
+    header.segmentCount = static_cast<uint16_t>(m_segments.size());
+    header.rawSize = static_cast<uint32_t>(m_frameSize);
+    header.packedSize = static_cast<uint32_t>(m_packedSize);
+    memcpy(out, &header, sizeof(header));
+    memcpy(out + sizeof(header), m_segments.data(),
+           m_segments.size() * sizeof(FramePackSegment));
+
+    uint8_t *dst = out + sizeof(header) +
+                   m_segments.size() * sizeof(FramePackSegment);
+    for (const auto &segment : m_segments) {
+        const uint8_t *src = frame + segment.rawOffset;
+        if (segment.bits == 12) {
+            const size_t count = segment.rawBytes / sizeof(uint16_t);
+            pack12(reinterpret_cast<const uint16_t *>(src), count, dst);
+            dst += packed_bytes(count);
+        } else {
+            memcpy(dst, src, segment.rawBytes);
+            dst += segment.rawBytes;
+        }
+    }
+}
+
+aditof::Status FramePacker::unpack(const uint8_t *data, size_t size,
+                                   uint8_t *frame, size_t frameSize) {
+    FramePackHeader header;
+    if (size < sizeof(header)) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    memcpy(&header, data, sizeof(header));
+    const size_t tableEnd =
+        sizeof(header) + header.segmentCount * sizeof(FramePackSegment);
+    if (header.magic != FRAME_PACK_MAGIC ||
+        header.version != FRAME_PACK_VERSION || header.packedSize != size ||
+        header.rawSize > frameSize || tableEnd > size) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    // frame may not be 16-bit aligned
+    std::vector<uint16_t> values;
+    size_t offset = tableEnd;
+    for (size_t i = 0; i < header.segmentCount; ++i) {
+        FramePackSegment segment;
+        memcpy(&segment, data + sizeof(header) + i * sizeof(segment),
+               sizeof(segment));
+
+        const bool packed = segment.bits == 12;
+        const size_t count = segment.rawBytes / sizeof(uint16_t);
+        const size_t bytes = packed ? packed_bytes(count) : segment.rawBytes;
+        if (!segment.rawBytes ||
+            (packed && segment.rawBytes % sizeof(uint16_t)) ||
+            (!packed && segment.bits != 16) ||
+            segment.rawOffset + static_cast<size_t>(segment.rawBytes) >
+                header.rawSize ||
+            bytes > size - offset) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+
+        if (packed) {
+            values.resize(count);
+            unpack12(data + offset, count, values.data());
+            memcpy(frame + segment.rawOffset, values.data(), segment.rawBytes);
+        } else {
+            memcpy(frame + segment.rawOffset, data + offset, segment.rawBytes);
+        }
+        offset += bytes;
+    }
+    return aditof::Status::OK;
+}
@@ -0,0 +1,114 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_PACK_H
+#define FRAME_PACK_H
+
+#include <aditof/status_definitions.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief 12-bit packing of the depth and AB planes for the stream socket.
+ *
+ * Depth and AB values rarely need more than 12 of their 16 bits. Packing
+ * two of them in 3 bytes cuts those planes by a quarter for a fraction of
+ * the cost of FrameCodec. Larger values are clamped to 4095.
+ *
+ * A packed frame is a FramePackHeader, a FramePackSegment per run of the
+ * frame and the runs one after the other. Runs are either copied as they are
+ * or packed: values v0, v1 go in bytes v0 & 0xff, (v0 >> 8) | (v1 << 4) and
+ * v1 >> 4, and an odd last value takes 2 bytes. The metadata at the start of
+ * the AB plane is never packed. All fields are little-endian.
+ */
+struct FramePackHeader {
+    uint32_t magic;        // FRAME_PACK_MAGIC
+    uint16_t version;      // FRAME_PACK_VERSION
+    uint16_t segmentCount; // FramePackSegment entries that follow
+    uint32_t rawSize;      // bytes of the unpacked frame
+    uint32_t packedSize;   // bytes of the packed frame, this header included
+};
+
+struct FramePackSegment {
+    uint32_t rawOffset; // where the run starts in the unpacked frame
+    uint32_t rawBytes;  // size of the run in the unpacked frame
+    uint16_t bits;      // 12 when packed, 16 when copied
+    uint16_t reserved;
+};
+
+static_assert(sizeof(FramePackHeader) == 16, "FramePackHeader is part of the "
+                                             "wire protocol");
+static_assert(sizeof(FramePackSegment) == 12, "FramePackSegment is part of "
+                                              "the wire protocol");
+
+static const uint32_t FRAME_PACK_MAGIC = 0x50464441; // "ADFP"
+static const uint16_t FRAME_PACK_VERSION = 1;
+
+class FramePacker {
+  public:
+    /**
+     * @brief Prepares packing the planes given as FrameContent bits (depth
+     * and AB) of frames of frameSize bytes laid out as given (FrameLayout).
+     * Fails if none of them is in the frames.
+     */
+    aditof::Status configure(uint16_t layout, uint16_t width, uint16_t height,
+                             size_t frameSize, uint16_t packedContent);
+
+    size_t frameSize() const { return m_frameSize; }
+
+    /**
+     * @brief Size of every packed frame.
+     */
+    size_t packedSize() const { return m_packedSize; }
+
+    /**
+     * @brief Packs frame into out, which has room for packedSize() bytes.
+     */
+    void pack(const uint8_t *frame, uint8_t *out) const;
+
+    /**
+     * @brief Unpacks a packed frame into frame, which has room for frameSize
+     * bytes.
+     */
+    static aditof::Status unpack(const uint8_t *data, size_t size,
+                                 uint8_t *frame, size_t frameSize);
+
+  private:
+    void addRun(size_t offset, size_t bytes, bool packed);
+
+    std::vector<FramePackSegment> m_segments;
+    size_t m_frameSize = 0;
+    size_t m_packedSize = 0;
+};
+
+#endif // FRAME_PACK_H
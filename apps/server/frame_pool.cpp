@@ -0,0 +1,223 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_pool.h"
+
+#include <aditof/log.h>
+#include <algorithm>
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Size of the hugepages frame buffers are mapped on when available, the
+// default one on the targets
+static const size_t HUGE_PAGE_SIZE = 2 * 1024 * 1024;
+
+FramePool::~FramePool() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    for (Buffer *buffer : m_free) {
+        destroyBuffer(buffer);
+    }
+    m_free.clear();
+}
+
+aditof::Status FramePool::allocate(size_t bufferSize, size_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    ++m_generation;
+    m_bufferSize = bufferSize;
+
+    // Buffers that are big enough only change generation. The ones that are
+    // out (held by the capture thread or queued in ZMQ) take the new one
+    // when they come back.
+    if (m_count >= count && m_capacity >= bufferSize) {
+        for (Buffer *buffer : m_free) {
+            buffer->generation = m_generation;
+        }
+        ++m_reuses;
+        return aditof::Status::OK;
+    }
+
+    return replaceBuffers(std::max(bufferSize, m_reservedSize),
+                          std::max(count, m_reservedCount));
+}
+
+aditof::Status FramePool::reserve(size_t bufferSize, size_t count) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    m_reservedSize = bufferSize;
+    m_reservedCount = count;
+    if (m_count >= count && m_capacity >= bufferSize) {
+        return aditof::Status::OK;
+    }
+
+    return replaceBuffers(std::max(bufferSize, m_bufferSize),
+                          std::max(count, m_count));
+}
+
+aditof::Status FramePool::replaceBuffers(size_t bufferSize, size_t count) {
+    // Free buffers can go right away. The ones that are out belong to the
+    // previous reservation and are destroyed by release() when their last
+    // reference is dropped.
+    for (Buffer *buffer : m_free) {
+        destroyBuffer(buffer);
+    }
+    m_free.clear();
+    ++m_reservation;
+    m_capacity = bufferSize;
+    m_count = 0;
+
+    for (size_t i = 0; i < count; ++i) {
+        Buffer *buffer = mapBuffer(bufferSize);
+        if (!buffer) {
+            return aditof::Status::GENERIC_ERROR;
+        }
+        m_free.push_back(buffer);
+        ++m_count;
+    }
+
+    return aditof::Status::OK;
+}
+
+FramePool::Buffer *FramePool::mapBuffer(size_t bufferSize) {
+    const int prot = PROT_READ | PROT_WRITE;
+    const int flags = MAP_PRIVATE | MAP_ANONYMOUS;
+    bufferSize = std::max<size_t>(bufferSize, 1);
+    void *mem = MAP_FAILED;
+    size_t length = 0;
+    bool hugePages = false;
+
+#ifdef MAP_HUGETLB
+    // Frames span megabytes, so hugepages spare most of the TLB misses of
+    // reading and sending them. They need to be set aside by the system
+    // (vm.nr_hugepages), there are usually none.
+    length =
+        (bufferSize + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    mem = mmap(nullptr, length, prot, flags | MAP_HUGETLB, -1, 0);
+    hugePages = mem != MAP_FAILED;
+    if (!hugePages && !m_hugePagesWarned) {
+        LOG(INFO) << "No hugepages available for frame buffers, using "
+                     "regular pages";
+        m_hugePagesWarned = true;
+    }
+#endif
+    if (mem == MAP_FAILED) {
+        const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+        length = (bufferSize + pageSize - 1) / pageSize * pageSize;
+        mem = mmap(nullptr, length, prot, flags, -1, 0);
+        if (mem == MAP_FAILED) {
+            LOG(ERROR) << "Failed to allocate frame buffer of " << bufferSize
+                       << " bytes";
+            return nullptr;
+        }
+#ifdef MADV_HUGEPAGE
+        madvise(mem, length, MADV_HUGEPAGE);
+#endif
+    }
+
+    // Keep frame buffers resident so that the sensor and the network
+    // never wait on a page fault. Not fatal if RLIMIT_MEMLOCK is too low.
+    if (mlock(mem, length) != 0 && !m_lockWarned) {
+        LOG(WARNING) << "Unable to lock frame buffers in memory, "
+                        "continuing with pageable buffers";
+        m_lockWarned = true;
+    }
+
+    Buffer *buffer = new Buffer;
+    buffer->data = static_cast<uint8_t *>(mem);
+    buffer->capacity = length;
+    buffer->generation = m_generation;
+    buffer->reservation = m_reservation;
+    buffer->hugePages = hugePages;
+    buffer->pool = this;
+    if (hugePages) {
+        ++m_hugePageBuffers;
+    }
+
+    return buffer;
+}
+
+FramePool::Buffer *FramePool::acquire(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    if (!m_cv.wait_for(lock, timeout, [this] { return !m_free.empty(); })) {
+        ++m_exhausted;
+        return nullptr;
+    }
+
+    Buffer *buffer = m_free.back();
+    m_free.pop_back();
+    buffer->refs.store(1);
+
+    return buffer;
+}
+
+void FramePool::retain(Buffer *buffer) { buffer->refs.fetch_add(1); }
+
+void FramePool::release(Buffer *buffer) {
+    if (buffer->refs.fetch_sub(1) != 1) {
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (buffer->reservation != m_reservation) {
+            destroyBuffer(buffer);
+            return;
+        }
+        buffer->generation = m_generation;
+        m_free.push_back(buffer);
+    }
+    m_cv.notify_one();
+}
+
+zmq::message_t FramePool::toMessage(Buffer *buffer, size_t length,
+                                    size_t offset) {
+    retain(buffer);
+    ++m_zeroCopyFrames;
+    m_zeroCopyBytes += length;
+
+    return zmq::message_t(buffer->data + offset, length, &FramePool::zmqFree,
+                          buffer);
+}
+
+void FramePool::zmqFree(void * /*data*/, void *hint) {
+    // Called from a ZMQ I/O thread once the frame left the socket
+    Buffer *buffer = static_cast<Buffer *>(hint);
+    buffer->pool->release(buffer);
+}
+
+void FramePool::destroyBuffer(Buffer *buffer) {
+    munlock(buffer->data, buffer->capacity);
+    munmap(buffer->data, buffer->capacity);
+    if (buffer->hugePages) {
+        --m_hugePageBuffers;
+    }
+    delete buffer;
+}
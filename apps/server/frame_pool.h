@@ -0,0 +1,151 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_POOL_H
+#define FRAME_POOL_H
+
+#include <aditof/status_definitions.h>
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include <zmq.hpp>
+
+/**
+ * @brief Fixed set of page-locked frame buffers shared by the capture thread
+ * and the network sender.
+ *
+ * Buffers are reference counted. A frame handed to ZMQ with toMessage() keeps
+ * a reference until ZMQ has finished transmitting it, at which point the
+ * buffer goes back to the pool without ever being copied.
+ *
+ * Buffers are mapped on hugepages when the system has some to spare, and are
+ * kept by allocate() as long as they are big enough, so that switching modes
+ * doesn't go back to the allocator.
+ */
+class FramePool {
+  public:
+    struct Buffer {
+        uint8_t *data = nullptr;
+        size_t capacity = 0;
+        std::atomic<int> refs{0};
+        uint32_t generation = 0;
+        uint32_t reservation = 0; // set of buffers it was mapped with
+        bool hugePages = false;
+        FramePool *pool = nullptr;
+
+        // Filled by the capture thread for the frame currently held
+        uint64_t captureIndex = 0;
+        int64_t captureTimestamp = 0;
+    };
+
+    FramePool() = default;
+    ~FramePool();
+
+    FramePool(const FramePool &) = delete;
+    FramePool &operator=(const FramePool &) = delete;
+
+    /**
+     * @brief Starts a new generation of count buffers of bufferSize bytes.
+     * The current buffers are kept when there are enough of them and they
+     * are big enough, including the ones still referenced by ZMQ, which come
+     * back when released. Otherwise they are replaced, and the ones still
+     * referenced are freed once their last reference is dropped.
+     */
+    aditof::Status allocate(size_t bufferSize, size_t count);
+
+    /**
+     * @brief Maps count buffers of bufferSize bytes up front, so that every
+     * later allocate() of up to that much reuses them.
+     */
+    aditof::Status reserve(size_t bufferSize, size_t count);
+
+    /**
+     * @brief Takes a free buffer out of the pool, waiting up to timeout.
+     * @return The buffer holding one reference, or nullptr on timeout.
+     */
+    Buffer *acquire(std::chrono::milliseconds timeout);
+
+    void retain(Buffer *buffer);
+    void release(Buffer *buffer);
+
+    /**
+     * @brief Wraps length bytes of buffer starting at offset in a ZMQ message
+     * without copying. The message holds its own reference to the buffer.
+     */
+    zmq::message_t toMessage(Buffer *buffer, size_t length, size_t offset = 0);
+
+    size_t bufferSize() const { return m_bufferSize; }
+
+    /**
+     * @brief Generation of the buffers of the last allocate(), as found in
+     * Buffer::generation. Buffers of an older one hold frames of a previous
+     * mode.
+     */
+    uint32_t generation() const { return m_generation.load(); }
+
+    uint64_t zeroCopyFrames() const { return m_zeroCopyFrames.load(); }
+    uint64_t zeroCopyBytes() const { return m_zeroCopyBytes.load(); }
+    uint64_t exhaustedCount() const { return m_exhausted.load(); }
+    uint64_t reuseCount() const { return m_reuses.load(); }
+    size_t hugePageBuffers() const { return m_hugePageBuffers.load(); }
+
+  private:
+    static void zmqFree(void *data, void *hint);
+    aditof::Status replaceBuffers(size_t bufferSize, size_t count);
+    Buffer *mapBuffer(size_t bufferSize);
+    void destroyBuffer(Buffer *buffer);
+
+    std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::vector<Buffer *> m_free;
+    size_t m_bufferSize = 0;
+    std::atomic<uint32_t> m_generation{0};
+    uint32_t m_reservation = 0;
+    size_t m_capacity = 0; // of the buffers of the current reservation
+    size_t m_count = 0;
+    size_t m_reservedSize = 0;
+    size_t m_reservedCount = 0;
+    bool m_lockWarned = false;
+    bool m_hugePagesWarned = false;
+
+    std::atomic<uint64_t> m_zeroCopyFrames{0};
+    std::atomic<uint64_t> m_zeroCopyBytes{0};
+    std::atomic<uint64_t> m_exhausted{0};
+    std::atomic<uint64_t> m_reuses{0};
+    std::atomic<size_t> m_hugePageBuffers{0};
+};
+
+#endif // FRAME_POOL_H
@@ -0,0 +1,163 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_RING_H
+#define FRAME_RING_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+/**
+ * @brief What the producer does when it finds the ring full.
+ */
+enum class DropPolicy {
+    DROP_OLDEST, // discard the oldest queued frame, keep the latest one
+    DROP_NEWEST, // keep what is queued, discard the frame being pushed
+};
+
+/**
+ * @brief Bounded lock-free ring of pointers between one producer thread and
+ * one consumer thread.
+ *
+ * push() never blocks: when the ring is full the frame selected by the drop
+ * policy is handed back to the caller so it can be recycled. To implement
+ * drop-oldest without a lock, the read index is claimed with a CAS by
+ * whoever removes an element, so the producer can safely evict the oldest
+ * entry while the consumer is popping.
+ */
+template <typename T> class FrameRing {
+  public:
+    explicit FrameRing(size_t capacity = 4,
+                       DropPolicy policy = DropPolicy::DROP_OLDEST) {
+        reset(capacity, policy);
+    }
+
+    FrameRing(const FrameRing &) = delete;
+    FrameRing &operator=(const FrameRing &) = delete;
+
+    /**
+     * @brief Changes depth and policy. Must only be called while neither the
+     * producer nor the consumer is running and the ring is empty.
+     */
+    void reset(size_t capacity, DropPolicy policy) {
+        m_capacity = capacity > 0 ? capacity : 1;
+        m_policy = policy;
+        m_slots.reset(new std::atomic<T *>[m_capacity]);
+        for (size_t i = 0; i < m_capacity; ++i) {
+            m_slots[i].store(nullptr, std::memory_order_relaxed);
+        }
+        m_head.store(0);
+        m_tail.store(0);
+    }
+
+    /**
+     * @brief Producer side. Queues item.
+     * @return The element that was dropped to respect the policy (either the
+     * oldest queued one or item itself), nullptr if nothing was dropped.
+     */
+    T *push(T *item) {
+        const uint64_t head = m_head.load(std::memory_order_relaxed);
+        T *dropped = nullptr;
+
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        while (head - tail >= m_capacity) {
+            if (m_policy == DropPolicy::DROP_NEWEST) {
+                m_droppedNewest.fetch_add(1, std::memory_order_relaxed);
+                return item;
+            }
+
+            T *oldest = m_slots[tail % m_capacity].load(
+                std::memory_order_acquire);
+            if (m_tail.compare_exchange_weak(tail, tail + 1,
+                                             std::memory_order_acq_rel)) {
+                m_droppedOldest.fetch_add(1, std::memory_order_relaxed);
+                dropped = oldest;
+                break;
+            }
+            // tail was reloaded by the failed CAS, the consumer made room
+        }
+
+        m_slots[head % m_capacity].store(item, std::memory_order_release);
+        m_head.store(head + 1, std::memory_order_release);
+
+        return dropped;
+    }
+
+    /**
+     * @brief Consumer side. Takes the oldest queued element.
+     * @return The element or nullptr if the ring is empty.
+     */
+    T *pop() {
+        uint64_t tail = m_tail.load(std::memory_order_acquire);
+        while (true) {
+            const uint64_t head = m_head.load(std::memory_order_acquire);
+            if (tail == head) {
+                return nullptr;
+            }
+            T *item =
+                m_slots[tail % m_capacity].load(std::memory_order_acquire);
+            if (m_tail.compare_exchange_weak(tail, tail + 1,
+                                             std::memory_order_acq_rel)) {
+                return item;
+            }
+        }
+    }
+
+    bool empty() const { return size() == 0; }
+
+    size_t size() const {
+        const uint64_t tail = m_tail.load(std::memory_order_acquire);
+        const uint64_t head = m_head.load(std::memory_order_acquire);
+        return head > tail ? static_cast<size_t>(head - tail) : 0;
+    }
+
+    size_t capacity() const { return m_capacity; }
+    DropPolicy policy() const { return m_policy; }
+
+    uint64_t droppedOldest() const { return m_droppedOldest.load(); }
+    uint64_t droppedNewest() const { return m_droppedNewest.load(); }
+
+  private:
+    std::unique_ptr<std::atomic<T *>[]> m_slots;
+    size_t m_capacity = 0;
+    DropPolicy m_policy = DropPolicy::DROP_OLDEST;
+
+    // Monotonic indices, only their value modulo m_capacity addresses a slot
+    std::atomic<uint64_t> m_head{0}; // written by the producer only
+    std::atomic<uint64_t> m_tail{0}; // claimed with CAS by whoever removes
+
+    std::atomic<uint64_t> m_droppedOldest{0};
+    std::atomic<uint64_t> m_droppedNewest{0};
+};
+
+#endif // FRAME_RING_H
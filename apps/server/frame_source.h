@@ -0,0 +1,106 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <aditof/depth_sensor_interface.h>
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+/**
+ * @brief The part of aditof::DepthSensorInterface the server needs to stream
+ * frames: opening, mode selection, start/stop and getFrame().
+ *
+ * Streaming code only talks to this interface, so frames can come either
+ * from the depth sensor or from a hardware-free source used to benchmark the
+ * network path.
+ */
+class FrameSource {
+  public:
+    virtual ~FrameSource() = default;
+
+    virtual aditof::Status open() = 0;
+    virtual aditof::Status start() = 0;
+    virtual aditof::Status stop() = 0;
+    virtual aditof::Status getAvailableModes(std::vector<uint8_t> &modes) = 0;
+    virtual aditof::Status
+    getModeDetails(const uint8_t &modeName,
+                   aditof::DepthSensorModeDetails &details) = 0;
+    virtual aditof::Status setMode(const uint8_t &mode) = 0;
+    virtual aditof::Status
+    setMode(const aditof::DepthSensorModeDetails &type) = 0;
+    virtual aditof::Status getFrame(uint16_t *buffer) = 0;
+    virtual aditof::Status getName(std::string &name) const = 0;
+};
+
+/**
+ * @brief Frame source backed by a depth sensor of the SDK.
+ */
+class SensorFrameSource : public FrameSource {
+  public:
+    explicit SensorFrameSource(
+        std::shared_ptr<aditof::DepthSensorInterface> sensor)
+        : m_sensor(sensor) {}
+
+    aditof::Status open() override { return m_sensor->open(); }
+    aditof::Status start() override { return m_sensor->start(); }
+    aditof::Status stop() override { return m_sensor->stop(); }
+    aditof::Status getAvailableModes(std::vector<uint8_t> &modes) override {
+        return m_sensor->getAvailableModes(modes);
+    }
+    aditof::Status
+    getModeDetails(const uint8_t &modeName,
+                   aditof::DepthSensorModeDetails &details) override {
+        return m_sensor->getModeDetails(modeName, details);
+    }
+    aditof::Status setMode(const uint8_t &mode) override {
+        return m_sensor->setMode(mode);
+    }
+    aditof::Status
+    setMode(const aditof::DepthSensorModeDetails &type) override {
+        return m_sensor->setMode(type);
+    }
+    aditof::Status getFrame(uint16_t *buffer) override {
+        return m_sensor->getFrame(buffer);
+    }
+    aditof::Status getName(std::string &name) const override {
+        return m_sensor->getName(name);
+    }
+
+  private:
+    std::shared_ptr<aditof::DepthSensorInterface> m_sensor;
+};
+
+#endif // FRAME_SOURCE_H
@@ -0,0 +1,295 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_transform.h"
+#include "frame_header.h"
+
+#include <algorithm>
+#include <cstring>
+
+// FRAME_TRANSFORM_SCALAR leaves out the SIMD kernels, e.g. to test them
+// against the scalar code
+#if defined(FRAME_TRANSFORM_SCALAR)
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#include <arm_neon.h>
+#define FRAME_TRANSFORM_NEON
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define FRAME_TRANSFORM_SSE2
+#endif
+
+namespace {
+
+const size_t BAND_ROWS = 16;
+const uint16_t MAX_DECIMATION = 8;
+
+// Keeps every other value of a row: out[i] = in[2 * i]
+void sample2_row16(const uint16_t *in, uint16_t *out, size_t count) {
+    size_t i = 0;
+#if defined(FRAME_TRANSFORM_NEON)
+    for (; i + 8 <= count; i += 8) {
+        uint16x8x2_t v = vld2q_u16(in + 2 * i);
+        vst1q_u16(out + i, v.val[0]);
+    }
+#elif defined(FRAME_TRANSFORM_SSE2)
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+            in + 2 * i));
+        __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i *>(
+            in + 2 * i + 8));
+        // Sign extend the even values to 32 bits, then pack them back
+        a = _mm_srai_epi32(_mm_slli_epi32(a, 16), 16);
+        b = _mm_srai_epi32(_mm_slli_epi32(b, 16), 16);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i),
+                         _mm_packs_epi32(a, b));
+    }
+#endif
+    for (; i < count; ++i) {
+        out[i] = in[2 * i];
+    }
+}
+
+// Nearest valid depth of each 2x2 block. Subtracting one maps invalid (zero)
+// depths to 0xffff, so they only win when the whole block is invalid, and
+// adding one back turns that into zero again.
+void min2_row16(const uint16_t *row0, const uint16_t *row1, uint16_t *out,
+                size_t count) {
+    size_t i = 0;
+#if defined(FRAME_TRANSFORM_NEON)
+    const uint16x8_t one = vdupq_n_u16(1);
+    for (; i + 8 <= count; i += 8) {
+        uint16x8x2_t a = vld2q_u16(row0 + 2 * i);
+        uint16x8x2_t b = vld2q_u16(row1 + 2 * i);
+        uint16x8_t m = vminq_u16(
+            vminq_u16(vsubq_u16(a.val[0], one), vsubq_u16(a.val[1], one)),
+            vminq_u16(vsubq_u16(b.val[0], one), vsubq_u16(b.val[1], one)));
+        vst1q_u16(out + i, vaddq_u16(m, one));
+    }
+#elif defined(FRAME_TRANSFORM_SSE2)
+    // SSE2 only has a signed 16-bit min, so values are biased by 0x8000
+    const __m128i one = _mm_set1_epi16(1);
+    const __m128i bias = _mm_set1_epi16(static_cast<short>(0x8000));
+    auto load = [&](const uint16_t *p) {
+        __m128i v = _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+        return _mm_xor_si128(_mm_sub_epi16(v, one), bias);
+    };
+    auto pairs = [](__m128i v) {
+        // Min of each even value and the odd one after it, sign extended
+        v = _mm_min_epi16(v, _mm_srli_epi32(v, 16));
+        return _mm_srai_epi32(_mm_slli_epi32(v, 16), 16);
+    };
+    for (; i + 8 <= count; i += 8) {
+        __m128i a = _mm_min_epi16(load(row0 + 2 * i), load(row1 + 2 * i));
+        __m128i b =
+            _mm_min_epi16(load(row0 + 2 * i + 8), load(row1 + 2 * i + 8));
+        __m128i m = _mm_packs_epi32(pairs(a), pairs(b));
+        m = _mm_add_epi16(_mm_xor_si128(m, bias), one);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(out + i), m);
+    }
+#endif
+    for (; i < count; ++i) {
+        uint16_t m = std::min(
+            std::min<uint16_t>(row0[2 * i] - 1, row0[2 * i + 1] - 1),
+            std::min<uint16_t>(row1[2 * i] - 1, row1[2 * i + 1] - 1));
+        out[i] = static_cast<uint16_t>(m + 1);
+    }
+}
+
+void min_row16(const uint16_t *in, size_t stride, uint16_t *out, size_t count,
+               size_t d) {
+    if (d == 2) {
+        min2_row16(in, in + stride, out, count);
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t m = 0xffff;
+        for (size_t r = 0; r < d; ++r) {
+            const uint16_t *block = in + r * stride + i * d;
+            for (size_t c = 0; c < d; ++c) {
+                m = std::min<uint16_t>(m, block[c] - 1);
+            }
+        }
+        out[i] = static_cast<uint16_t>(m + 1);
+    }
+}
+
+void median_row16(const uint16_t *in, size_t stride, uint16_t *out,
+                  size_t count, size_t d) {
+    uint16_t valid[MAX_DECIMATION * MAX_DECIMATION];
+    for (size_t i = 0; i < count; ++i) {
+        size_t n = 0;
+        for (size_t r = 0; r < d; ++r) {
+            const uint16_t *block = in + r * stride + i * d;
+            for (size_t c = 0; c < d; ++c) {
+                if (block[c]) {
+                    valid[n++] = block[c];
+                }
+            }
+        }
+        if (!n) {
+            out[i] = 0;
+            continue;
+        }
+        std::nth_element(valid, valid + (n - 1) / 2, valid + n);
+        out[i] = valid[(n - 1) / 2];
+    }
+}
+
+void sample_row16(const uint16_t *in, uint16_t *out, size_t count, size_t d) {
+    if (d == 1) {
+        memcpy(out, in, count * sizeof(uint16_t));
+    } else if (d == 2) {
+        sample2_row16(in, out, count);
+    } else {
+        for (size_t i = 0; i < count; ++i) {
+            out[i] = in[i * d];
+        }
+    }
+}
+
+void sample_row32(const uint32_t *in, uint32_t *out, size_t count, size_t d) {
+    if (d == 1) {
+        memcpy(out, in, count * sizeof(uint32_t));
+        return;
+    }
+    for (size_t i = 0; i < count; ++i) {
+        out[i] = in[i * d];
+    }
+}
+
+} // namespace
+
+aditof::Status FrameTransform::configure(uint16_t layout, uint16_t width,
+                                         uint16_t height, uint16_t planeCount,
+                                         const FrameRegion &region) {
+    m_planes.clear();
+    m_outputSize = 0;
+    m_outWidth = 0;
+    m_outHeight = 0;
+    m_hasAb = false;
+
+    m_region = region;
+    if (!m_region.width || !m_region.height) {
+        m_region.x = 0;
+        m_region.y = 0;
+        m_region.width = width;
+        m_region.height = height;
+    }
+    const uint16_t d = m_region.decimation;
+    if (d < 1 || d > MAX_DECIMATION ||
+        m_region.x + m_region.width > width ||
+        m_region.y + m_region.height > height) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    m_width = width;
+    m_outWidth = m_region.width / d;
+    m_outHeight = m_region.height / d;
+    const size_t in = static_cast<size_t>(width) * height;
+    const size_t out = static_cast<size_t>(m_outWidth) * m_outHeight;
+    // The output AB plane must still have room for the metadata
+    if (out * sizeof(uint16_t) < FRAME_METADATA_SIZE) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    const bool pooled = m_region.pooling != FramePooling::SAMPLE;
+    if (layout == FRAME_LAYOUT_DEPTH_AB_CONF ||
+        layout == FRAME_LAYOUT_DEPTH_AB) {
+        m_planes.push_back({0, 0, 2, pooled});
+        m_planes.push_back({in * 2, out * 2, 2, false});
+        m_hasAb = true;
+        m_abIn = in * 2;
+        m_abOut = out * 2;
+        m_outputSize = out * 4;
+        if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+            m_planes.push_back({in * 4, out * 4, 4, false});
+            m_outputSize = out * 8;
+        }
+    } else if (layout == FRAME_LAYOUT_PCM) {
+        for (size_t p = 0; p < planeCount; ++p) {
+            m_planes.push_back({p * in * 2, p * out * 2, 2, false});
+        }
+        m_outputSize = out * 2 * planeCount;
+    } else {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    return aditof::Status::OK;
+}
+
+size_t FrameTransform::bandCount() const {
+    return (m_outHeight + BAND_ROWS - 1) / BAND_ROWS;
+}
+
+void FrameTransform::apply(const uint8_t *in, uint8_t *out,
+                           size_t band) const {
+    const size_t d = m_region.decimation;
+    const size_t first = band * BAND_ROWS;
+    const size_t last = std::min<size_t>(first + BAND_ROWS, m_outHeight);
+
+    for (const Plane &plane : m_planes) {
+        for (size_t row = first; row < last; ++row) {
+            const size_t inRow = m_region.y + row * d;
+            const size_t inPixel = inRow * m_width + m_region.x;
+            const size_t outPixel = row * m_outWidth;
+
+            if (plane.pixelSize == 4) {
+                sample_row32(
+                    reinterpret_cast<const uint32_t *>(in + plane.inOffset) +
+                        inPixel,
+                    reinterpret_cast<uint32_t *>(out + plane.outOffset) +
+                        outPixel,
+                    m_outWidth, d);
+                continue;
+            }
+
+            const uint16_t *src =
+                reinterpret_cast<const uint16_t *>(in + plane.inOffset) +
+                inPixel;
+            uint16_t *dst =
+                reinterpret_cast<uint16_t *>(out + plane.outOffset) +
+                outPixel;
+            if (!plane.pooled || d == 1) {
+                sample_row16(src, dst, m_outWidth, d);
+            } else if (m_region.pooling == FramePooling::MIN) {
+                min_row16(src, m_width, dst, m_outWidth, d);
+            } else {
+                median_row16(src, m_width, dst, m_outWidth, d);
+            }
+        }
+    }
+}
+
+void FrameTransform::finish(const uint8_t *in, uint8_t *out) const {
+    if (m_hasAb) {
+        memcpy(out + m_abOut, in + m_abIn, FRAME_METADATA_SIZE);
+    }
+}
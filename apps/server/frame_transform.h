@@ -0,0 +1,114 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef FRAME_TRANSFORM_H
+#define FRAME_TRANSFORM_H
+
+#include <aditof/status_definitions.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief How a decimated depth pixel is made from its block of pixels.
+ * AB, confidence and PCM planes are always sampled.
+ */
+enum class FramePooling : uint16_t {
+    SAMPLE = 0, // top-left pixel of the block
+    MIN = 1,    // nearest valid (non zero) depth of the block
+    MEDIAN = 2, // median of the valid depths of the block
+};
+
+/**
+ * @brief Part of the image a client wants, and how much to shrink it.
+ */
+struct FrameRegion {
+    uint16_t x = 0;
+    uint16_t y = 0;
+    uint16_t width = 0; // 0 for the whole image
+    uint16_t height = 0;
+    uint16_t decimation = 1; // keep one pixel in decimation x decimation
+    FramePooling pooling = FramePooling::SAMPLE;
+};
+
+/**
+ * @brief Crops and decimates the planes of a frame.
+ *
+ * The output has the layout of the input with the smaller resolution. The
+ * 128-byte metadata block found at the start of the AB plane is carried over
+ * to the start of the output AB plane. Rows are processed in bands that can
+ * be transformed by different threads.
+ */
+class FrameTransform {
+  public:
+    /**
+     * @brief Prepares transforming frames of the given layout (FrameLayout)
+     * and resolution.
+     */
+    aditof::Status configure(uint16_t layout, uint16_t width, uint16_t height,
+                             uint16_t planeCount, const FrameRegion &region);
+
+    uint16_t outputWidth() const { return m_outWidth; }
+    uint16_t outputHeight() const { return m_outHeight; }
+    size_t outputSize() const { return m_outputSize; }
+    size_t bandCount() const;
+
+    /**
+     * @brief Transforms the output rows of band from in to out.
+     */
+    void apply(const uint8_t *in, uint8_t *out, size_t band) const;
+
+    /**
+     * @brief Copies the metadata once all bands are done.
+     */
+    void finish(const uint8_t *in, uint8_t *out) const;
+
+  private:
+    struct Plane {
+        size_t inOffset;
+        size_t outOffset;
+        size_t pixelSize; // 2 or 4 bytes
+        bool pooled;      // depth
+    };
+
+    std::vector<Plane> m_planes;
+    FrameRegion m_region;
+    uint16_t m_width = 0;
+    uint16_t m_outWidth = 0;
+    uint16_t m_outHeight = 0;
+    size_t m_outputSize = 0;
+    size_t m_abIn = 0; // AB planes, for the metadata
+    size_t m_abOut = 0;
+    bool m_hasAb = false;
+};
+
+#endif // FRAME_TRANSFORM_H
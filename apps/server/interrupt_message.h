@@ -0,0 +1,62 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef INTERRUPT_MESSAGE_H
+#define INTERRUPT_MESSAGE_H
+
+#include <cstdint>
+
+/**
+ * @brief Message published on the interrupt port for every ADSD3500
+ * interrupt, as soon as the server sees it.
+ *
+ * All fields are little-endian. The timestamp is CLOCK_REALTIME nanoseconds,
+ * like those of FrameHeader. The first 8 bytes are the same for every
+ * message of a sensor, so a client can subscribe to one sensor with them.
+ */
+struct InterruptMessage {
+    uint32_t magic;    // INTERRUPT_MESSAGE_MAGIC
+    uint16_t version;  // INTERRUPT_MESSAGE_VERSION
+    uint16_t sensor;   // sensor_index of the sensor
+    int32_t status;    // aditof::Adsd3500Status
+    uint32_t dropped;  // interrupts lost since the previous message
+    uint64_t sequence; // interrupts of the sensor since the server started
+    int64_t timestamp; // when the sensor reported the interrupt
+};
+
+static_assert(sizeof(InterruptMessage) == 32,
+              "InterruptMessage is part of the wire protocol, its size must "
+              "not change");
+
+static const uint32_t INTERRUPT_MESSAGE_MAGIC = 0x52494441; // "ADIR"
+static const uint16_t INTERRUPT_MESSAGE_VERSION = 1;
+
+#endif // INTERRUPT_MESSAGE_H
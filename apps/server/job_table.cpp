@@ -0,0 +1,113 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "job_table.h"
+
+#include <utility>
+
+uint32_t JobTable::add() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_jobs.size() >= m_capacity) {
+        return 0;
+    }
+    uint32_t id = m_nextId++;
+    if (m_nextId == 0) {
+        m_nextId = 1;
+    }
+    m_jobs[id] = Job();
+    ++m_pending;
+    return id;
+}
+
+bool JobTable::start(uint32_t id) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto job = m_jobs.find(id);
+    if (job == m_jobs.end()) {
+        return false;
+    }
+    job->second.state = State::RUNNING;
+    return true;
+}
+
+void JobTable::finish(uint32_t id, std::string reply) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        auto job = m_jobs.find(id);
+        if (job != m_jobs.end()) {
+            job->second.state = State::DONE;
+            job->second.reply = std::move(reply);
+            m_finished.push_back(id);
+        }
+        --m_pending;
+    }
+    m_cv.notify_all();
+}
+
+bool JobTable::take(uint32_t id, State &state, std::string &reply) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    auto job = m_jobs.find(id);
+    if (job == m_jobs.end()) {
+        return false;
+    }
+    state = job->second.state;
+    if (state == State::DONE) {
+        reply = std::move(job->second.reply);
+        m_jobs.erase(job);
+    }
+    return true;
+}
+
+std::vector<uint32_t> JobTable::takeFinished() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<uint32_t> finished;
+    finished.swap(m_finished);
+    return finished;
+}
+
+size_t JobTable::pending() const {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_pending;
+}
+
+void JobTable::cancel() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    for (auto job = m_jobs.begin(); job != m_jobs.end();) {
+        if (job->second.state == State::QUEUED) {
+            job = m_jobs.erase(job);
+            --m_pending;
+        } else {
+            ++job;
+        }
+    }
+    m_cv.wait(lock, [this]() { return m_pending == 0; });
+    m_jobs.clear();
+    m_finished.clear();
+}
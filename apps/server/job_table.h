@@ -0,0 +1,111 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef JOB_TABLE_H
+#define JOB_TABLE_H
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Requests run in the background, known by id until their reply is
+ * read. A job is queued, then running, then done with its reply stored.
+ */
+class JobTable {
+  public:
+    enum class State { QUEUED, RUNNING, DONE };
+
+    /**
+     * @brief Keeps at most capacity jobs, pending or done and not yet read.
+     */
+    explicit JobTable(size_t capacity = 64) : m_capacity(capacity) {}
+
+    JobTable(const JobTable &) = delete;
+    JobTable &operator=(const JobTable &) = delete;
+
+    /**
+     * @brief Adds a queued job and returns its id, 0 if the table is full.
+     */
+    uint32_t add();
+
+    /**
+     * @brief Marks the job running. Returns false if it was cancelled.
+     */
+    bool start(uint32_t id);
+
+    /**
+     * @brief Stores the reply of a running job.
+     */
+    void finish(uint32_t id, std::string reply);
+
+    /**
+     * @brief Gives the state of a job and, once it is done, its reply, which
+     * is then forgotten. Returns false for an unknown job.
+     */
+    bool take(uint32_t id, State &state, std::string &reply);
+
+    /**
+     * @brief Ids of the jobs done since the last call.
+     */
+    std::vector<uint32_t> takeFinished();
+
+    /**
+     * @brief Jobs queued or running.
+     */
+    size_t pending() const;
+
+    /**
+     * @brief Drops the queued jobs, waits for the running one and forgets
+     * them all. Ids are not reused.
+     */
+    void cancel();
+
+  private:
+    struct Job {
+        State state = State::QUEUED;
+        std::string reply;
+    };
+
+    mutable std::mutex m_mutex;
+    std::condition_variable m_cv;
+    std::map<uint32_t, Job> m_jobs;
+    std::vector<uint32_t> m_finished;
+    size_t m_pending = 0;
+    uint32_t m_nextId = 1;
+    const size_t m_capacity;
+};
+
+#endif // JOB_TABLE_H
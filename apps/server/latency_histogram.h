@@ -0,0 +1,118 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef LATENCY_HISTOGRAM_H
+#define LATENCY_HISTOGRAM_H
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+
+/**
+ * @brief Lock-free histogram of durations with power-of-two microsecond
+ * buckets. Bucket i counts samples up to 2^i us, the last bucket everything
+ * above. Safe to record from one thread while others read it.
+ */
+class LatencyHistogram {
+  public:
+    static constexpr size_t BUCKET_COUNT = 26; // 1 us .. ~33 s
+
+    void record(std::chrono::nanoseconds duration) {
+        const uint64_t us = static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::microseconds>(duration)
+                .count());
+        size_t bucket = 0;
+        while (bucket < BUCKET_COUNT - 1 && (1ull << bucket) < us) {
+            ++bucket;
+        }
+        m_buckets[bucket].fetch_add(1, std::memory_order_relaxed);
+        m_count.fetch_add(1, std::memory_order_relaxed);
+        m_sumUs.fetch_add(us, std::memory_order_relaxed);
+
+        uint64_t max = m_maxUs.load(std::memory_order_relaxed);
+        while (us > max && !m_maxUs.compare_exchange_weak(
+                               max, us, std::memory_order_relaxed)) {
+        }
+    }
+
+    /**
+     * @brief Upper bound in us of the bucket holding the given percentile
+     * (0..100), 0 if nothing was recorded.
+     */
+    uint64_t percentileUs(double percentile) const {
+        const uint64_t count = m_count.load();
+        if (count == 0) {
+            return 0;
+        }
+        const uint64_t rank =
+            static_cast<uint64_t>(percentile / 100.0 * (count - 1)) + 1;
+        uint64_t seen = 0;
+        for (size_t i = 0; i < BUCKET_COUNT; ++i) {
+            seen += m_buckets[i].load();
+            if (seen >= rank) {
+                return i == BUCKET_COUNT - 1 ? m_maxUs.load()
+                                             : bucketUpperUs(i);
+            }
+        }
+        return m_maxUs.load();
+    }
+
+    static uint64_t bucketUpperUs(size_t bucket) { return 1ull << bucket; }
+    uint64_t bucketCount(size_t bucket) const {
+        return m_buckets[bucket].load();
+    }
+
+    uint64_t count() const { return m_count.load(); }
+    uint64_t sumUs() const { return m_sumUs.load(); }
+    uint64_t maxUs() const { return m_maxUs.load(); }
+    uint64_t meanUs() const {
+        const uint64_t count = m_count.load();
+        return count ? m_sumUs.load() / count : 0;
+    }
+
+    void reset() {
+        for (auto &bucket : m_buckets) {
+            bucket.store(0);
+        }
+        m_count.store(0);
+        m_sumUs.store(0);
+        m_maxUs.store(0);
+    }
+
+  private:
+    std::atomic<uint64_t> m_buckets[BUCKET_COUNT] = {};
+    std::atomic<uint64_t> m_count{0};
+    std::atomic<uint64_t> m_sumUs{0};
+    std::atomic<uint64_t> m_maxUs{0};
+};
+
+#endif // LATENCY_HISTOGRAM_H
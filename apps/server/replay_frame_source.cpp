@@ -0,0 +1,320 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "replay_frame_source.h"
+#include "frame_header.h"
+
+#include <aditof/log.h>
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+
+struct ReplayMode {
+    uint8_t number;
+    int width;
+    int height;
+    bool pcm;
+};
+
+// Modes reported by an ADSD3500 with the default configuration
+const ReplayMode REPLAY_MODES[] = {
+    {0, 1024, 1024, false}, // sr-native
+    {1, 1024, 1024, false}, // lr-native
+    {2, 512, 512, false},   // sr-qnative
+    {3, 512, 512, false},   // lr-qnative
+    {4, 1024, 1024, true},  // pcm-native
+    {5, 512, 512, false},   // sr-mixed
+    {6, 512, 512, false},   // lr-mixed
+};
+
+// Bytes of a frame as laid out by the server: depth, AB and a 32-bit
+// confidence per pixel, or the phases of a PCM mode.
+size_t frame_size_bytes(const aditof::DepthSensorModeDetails &details) {
+    size_t pixels = static_cast<size_t>(details.baseResolutionWidth) *
+                    details.baseResolutionHeight;
+    if (details.isPCM) {
+        return pixels * details.numberOfPhases * sizeof(uint16_t);
+    }
+    return pixels * 4 * sizeof(uint16_t);
+}
+
+} // namespace
+
+ReplayFrameSource::ReplayFrameSource(const ReplayConfig &config)
+    : m_config(config) {
+    for (const ReplayMode &mode : REPLAY_MODES) {
+        aditof::DepthSensorModeDetails details;
+        details.modeNumber = mode.number;
+        details.pixelFormatIndex = 0;
+        details.baseResolutionWidth = mode.width;
+        details.baseResolutionHeight = mode.height;
+        if (config.width > 0 && config.height > 0) {
+            details.baseResolutionWidth = config.width;
+            details.baseResolutionHeight = config.height;
+        }
+        details.frameWidthInBytes = details.baseResolutionWidth;
+        details.frameHeightInBytes = details.baseResolutionHeight;
+        details.metadataSize = 128;
+        details.isPCM = mode.pcm ? 1 : 0;
+        details.numberOfPhases = 1;
+        details.numberOfFrequencies = 1;
+        if (mode.pcm) {
+            details.frameContent = {"ab", "metadata"};
+        } else {
+            details.frameContent = {"raw",  "depth", "ab",
+                                    "conf", "xyz",   "metadata"};
+        }
+        m_modes.emplace_back(details);
+    }
+    m_mode = m_modes.front();
+    m_frameSize = frame_size_bytes(m_mode);
+}
+
+ReplayFrameSource::~ReplayFrameSource() { unmapRecording(); }
+
+aditof::Status ReplayFrameSource::open() {
+    if (m_config.path.empty()) {
+        return aditof::Status::OK;
+    }
+
+    int fd = ::open(m_config.path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        LOG(ERROR) << "Unable to open recording " << m_config.path << ": "
+                   << strerror(errno);
+        return aditof::Status::UNREACHABLE;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) < 0 || st.st_size == 0) {
+        LOG(ERROR) << "Recording " << m_config.path << " is empty";
+        ::close(fd);
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    unmapRecording();
+    void *data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (data == MAP_FAILED) {
+        LOG(ERROR) << "Unable to map recording " << m_config.path << ": "
+                   << strerror(errno);
+        return aditof::Status::GENERIC_ERROR;
+    }
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+
+    m_recording = static_cast<const uint8_t *>(data);
+    m_recordingSize = st.st_size;
+    // Until a mode is set, frames are replayed in the first one
+    m_recordedFrames = m_recordingSize / m_frameSize;
+    return aditof::Status::OK;
+}
+
+aditof::Status ReplayFrameSource::start() {
+    if (m_recording && !m_recordedFrames) {
+        LOG(ERROR) << "Recording " << m_config.path
+                   << " holds no complete frame of mode "
+                   << static_cast<int>(m_mode.modeNumber)
+                   << ", set another mode";
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    m_started = true;
+    m_frameIndex = 0;
+    m_nextFrameTime = std::chrono::steady_clock::now();
+    return aditof::Status::OK;
+}
+
+aditof::Status ReplayFrameSource::stop() {
+    m_started = false;
+    return aditof::Status::OK;
+}
+
+aditof::Status
+ReplayFrameSource::getAvailableModes(std::vector<uint8_t> &modes) {
+    modes.clear();
+    for (const auto &details : m_modes) {
+        modes.emplace_back(details.modeNumber);
+    }
+    return aditof::Status::OK;
+}
+
+aditof::Status
+ReplayFrameSource::getModeDetails(const uint8_t &modeName,
+                                  aditof::DepthSensorModeDetails &details) {
+    for (const auto &mode : m_modes) {
+        if (mode.modeNumber == modeName) {
+            details = mode;
+            return aditof::Status::OK;
+        }
+    }
+    return aditof::Status::INVALID_ARGUMENT;
+}
+
+aditof::Status ReplayFrameSource::setMode(const uint8_t &mode) {
+    aditof::DepthSensorModeDetails details;
+    aditof::Status status = getModeDetails(mode, details);
+    if (status != aditof::Status::OK) {
+        LOG(ERROR) << "Mode " << static_cast<int>(mode)
+                   << " is not available";
+        return status;
+    }
+    return setMode(details);
+}
+
+aditof::Status
+ReplayFrameSource::setMode(const aditof::DepthSensorModeDetails &type) {
+    size_t frameSize = frame_size_bytes(type);
+    if (frameSize == 0) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    if (m_recording) {
+        if (m_recordingSize < frameSize) {
+            LOG(ERROR) << "Recording " << m_config.path
+                       << " holds no complete frame of mode "
+                       << static_cast<int>(type.modeNumber) << " ("
+                       << frameSize << " bytes)";
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+        if (m_recordingSize % frameSize) {
+            LOG(WARNING) << "Recording " << m_config.path
+                         << " ends with a partial frame, ignoring it";
+        }
+        m_recordedFrames = m_recordingSize / frameSize;
+    }
+
+    m_mode = type;
+    m_frameSize = frameSize;
+    m_frameIndex = 0;
+    return aditof::Status::OK;
+}
+
+aditof::Status ReplayFrameSource::getFrame(uint16_t *buffer) {
+    if (!m_started) {
+        LOG(WARNING) << "getFrame() called before start()";
+        return aditof::Status::UNAVAILABLE;
+    }
+
+    if (m_config.fps) {
+        using namespace std::chrono;
+        const auto period = duration_cast<steady_clock::duration>(
+            duration<double>(1.0 / m_config.fps));
+        m_nextFrameTime += period;
+        auto now = steady_clock::now();
+        if (m_nextFrameTime > now) {
+            std::this_thread::sleep_until(m_nextFrameTime);
+        } else if (now - m_nextFrameTime > period) {
+            // The reader fell behind, don't make up for the lost frames
+            m_nextFrameTime = now;
+        }
+    }
+
+    if (m_recording) {
+        const uint8_t *frame =
+            m_recording + (m_frameIndex % m_recordedFrames) * m_frameSize;
+        memcpy(buffer, frame, m_frameSize);
+    } else {
+        renderSyntheticFrame(buffer);
+    }
+
+    ++m_frameIndex;
+    return aditof::Status::OK;
+}
+
+aditof::Status ReplayFrameSource::getName(std::string &name) const {
+    name = m_config.path.empty() ? "synthetic" : "replay";
+    return aditof::Status::OK;
+}
+
+void ReplayFrameSource::renderSyntheticFrame(uint16_t *buffer) const {
+    const int width = m_mode.baseResolutionWidth;
+    const int height = m_mode.baseResolutionHeight;
+    const size_t pixels = static_cast<size_t>(width) * height;
+    const uint32_t frame = static_cast<uint32_t>(m_frameIndex);
+
+    // A square object closer than the background, crossing the scene
+    const int boxSize = std::max(8, std::min(width, height) / 8);
+    const int boxX = static_cast<int>((frame * 8) % width);
+    const int boxY = (height - boxSize) / 2;
+
+    const int planes = m_mode.isPCM ? m_mode.numberOfPhases : 1;
+    uint16_t *depth = buffer;
+    uint16_t *ab = m_mode.isPCM ? buffer : buffer + pixels;
+
+    for (int y = 0; y < height; ++y) {
+        const bool boxRow = y >= boxY && y < boxY + boxSize;
+        for (int x = 0; x < width; ++x) {
+            const size_t i = static_cast<size_t>(y) * width + x;
+            const bool inBox = boxRow && x >= boxX && x < boxX + boxSize;
+            const uint32_t noise =
+                ((x * 7u + y * 13u + frame * 31u) * 2654435761u) >> 30;
+
+            if (!m_mode.isPCM) {
+                depth[i] = static_cast<uint16_t>(
+                    inBox ? 600 + noise : 1000 + 2 * x + y + noise);
+            }
+            ab[i] = static_cast<uint16_t>(
+                (inBox ? 2000 : 100 + ((x ^ y) & 0xff)) + noise);
+        }
+    }
+
+    if (m_mode.isPCM) {
+        for (int p = 1; p < planes; ++p) {
+            memcpy(buffer + p * pixels, buffer, pixels * sizeof(uint16_t));
+        }
+    } else {
+        // Confidence is not simulated
+        memset(buffer + 2 * pixels, 0, pixels * 2 * sizeof(uint16_t));
+
+        // Like the sensor, number the frames in the metadata at the start of
+        // the AB plane
+        if (pixels * sizeof(uint16_t) >= FRAME_METADATA_SIZE) {
+            uint8_t *metadata = reinterpret_cast<uint8_t *>(ab);
+            memset(metadata, 0, FRAME_METADATA_SIZE);
+            memcpy(metadata + FRAME_METADATA_FRAME_NUMBER, &frame,
+                   sizeof(frame));
+        }
+    }
+}
+
+void ReplayFrameSource::unmapRecording() {
+    if (m_recording) {
+        munmap(const_cast<uint8_t *>(m_recording), m_recordingSize);
+        m_recording = nullptr;
+        m_recordingSize = 0;
+        m_recordedFrames = 0;
+    }
+}
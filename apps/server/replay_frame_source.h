@@ -0,0 +1,97 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef REPLAY_FRAME_SOURCE_H
+#define REPLAY_FRAME_SOURCE_H
+
+#include "frame_source.h"
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @brief Settings of a ReplayFrameSource, taken from the command line.
+ */
+struct ReplayConfig {
+    std::string path;        // recorded frames, empty for the synthetic pattern
+    unsigned int fps = 30;   // 0 delivers frames as fast as they are requested
+    int width = 0;           // overrides the resolution of every mode when
+    int height = 0;          // both are non zero
+};
+
+/**
+ * @brief Hardware-free frame source.
+ *
+ * Exposes the modes of an ADSD3500 and delivers frames at a fixed rate,
+ * either generated (a deterministic pattern with a moving object and a bit of
+ * noise on depth) or read in a loop from a file of recorded frames. A
+ * recording is raw frames of the selected mode back to back, exactly as they
+ * are sent to clients without a frame header.
+ */
+class ReplayFrameSource : public FrameSource {
+  public:
+    explicit ReplayFrameSource(const ReplayConfig &config);
+    ~ReplayFrameSource() override;
+
+    aditof::Status open() override;
+    aditof::Status start() override;
+    aditof::Status stop() override;
+    aditof::Status getAvailableModes(std::vector<uint8_t> &modes) override;
+    aditof::Status
+    getModeDetails(const uint8_t &modeName,
+                   aditof::DepthSensorModeDetails &details) override;
+    aditof::Status setMode(const uint8_t &mode) override;
+    aditof::Status
+    setMode(const aditof::DepthSensorModeDetails &type) override;
+    aditof::Status getFrame(uint16_t *buffer) override;
+    aditof::Status getName(std::string &name) const override;
+
+  private:
+    void renderSyntheticFrame(uint16_t *buffer) const;
+    void unmapRecording();
+
+    ReplayConfig m_config;
+    std::vector<aditof::DepthSensorModeDetails> m_modes;
+    aditof::DepthSensorModeDetails m_mode;
+    size_t m_frameSize = 0; // bytes per frame in the current mode
+    bool m_started = false;
+    uint64_t m_frameIndex = 0;
+    std::chrono::steady_clock::time_point m_nextFrameTime;
+
+    const uint8_t *m_recording = nullptr;
+    size_t m_recordingSize = 0;
+    size_t m_recordedFrames = 0;
+};
+
+#endif // REPLAY_FRAME_SOURCE_H
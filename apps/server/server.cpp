@@ -34,106 +34,1163 @@
 #include "aditof/sensor_enumerator_factory.h"
 #include "aditof/sensor_enumerator_interface.h"
 #include "buffer.pb.h"
+#include "frame_codec.h"
+#include "frame_content.h"
+#include "frame_fanout.h"
+#include "frame_header.h"
+#include "frame_pack.h"
+#include "frame_pool.h"
+#include "frame_ring.h"
+#include "frame_source.h"
+#include "frame_transform.h"
+#include "interrupt_message.h"
+#include "job_table.h"
+#include "latency_histogram.h"
+#include "mpsc_ring.h"
+#include "replay_frame_source.h"
+#include "server_stats.h"
+#include "shm_frame_ring.h"
+#include "thread_placement.h"
+#include "tile_delta.h"
+#include "worker_pool.h"
 
 #include "../../sdk/src/connections/target/v4l_buffer_access_interface.h"
 
 #include <aditof/log.h>
 #include <algorithm>
 #include <atomic>
+#include <cerrno>
+#include <command_parser.h>
 #include <condition_variable>
-#include <future>
+#include <deque>
 #include <iostream>
 #include <linux/videodev2.h>
 #include <map>
-#include <queue>
+#include <poll.h>
 #include <string>
+#include <sys/eventfd.h>
 #include <sys/time.h>
 #include <thread>
+#include <unistd.h>
 
 using namespace google::protobuf::io;
 
 static const int FRAME_PREPADDING_BYTES = 2;
 static int interrupted = 0;
 
+static const char Help_Menu[] =
+    R"(aditof-server usage:
+    aditof-server
+    aditof-server (-h | --help)
+    aditof-server [-rd | --ring-depth <depth>] [-dp | --drop-policy <policy>]
+                  [-cw | --compress-workers <count>]
+                  [-shm | --shm-name <name>] [-fo | --fan-out <count>]
+                  [-cc | --capture-cpu <cpu[:priority]>]
+                  [-pc | --process-cpu <cpu[:priority]>]
+                  [-sc | --send-cpu <cpu[:priority]>]
+                  [-wg | --warm-grace <seconds>]
+                  [-ir | --interrupt-port <port>]
+                  [-sy | --synthetic | -rp | --replay <file>] [-fps <rate>]
+                  [-rs | --replay-size <width>x<height>]
+
+    Options:
+      -h --help                    Show this screen.
+      -rd --ring-depth <depth>     Number of captured frames that can wait to
+                                   be sent. [default: 4]
+      -dp --drop-policy <policy>   Frame to drop when the capture ring is full:
+                                   oldest or newest. [default: oldest]
+      -cw --compress-workers <count>
+                                   Threads helping the sender compress frames
+                                   for clients that ask for it. [default: 2]
+      -shm --shm-name <name>       Shared memory ring frames are written to
+                                   for local clients that ask for it, with
+                                   -1, -2... for the other sensors.
+                                   [default: /aditof-frames]
+      -fo --fan-out <count>        Number of extra clients that can subscribe
+                                   to the stream of each sensor, on ports
+                                   5560 and up. [default: 0]
+      -cc --capture-cpu <cpu[:priority]>
+                                   CPU the capture stage (getFrame and depth
+                                   compute) runs on, and optionally its
+                                   SCHED_FIFO priority (1 to 99).
+      -pc --process-cpu <cpu[:priority]>
+                                   Same for the process stage (region,
+                                   content and encoding of frames).
+      -sc --send-cpu <cpu[:priority]>
+                                   Same for the send stage and the ZMQ I/O
+                                   thread writing to the network.
+      -wg --warm-grace <seconds>   Time a sensor stays open, in its mode and
+                                   with depth compute, after its client went
+                                   away without HangUp, for a reconnecting
+                                   client to pick it up. 0 closes it right
+                                   away. [default: 30]
+      -ir --interrupt-port <port>  Port ADSD3500 interrupts are published on
+                                   as they happen, 0 for none.
+                                   [default: 5557]
+      -sy --synthetic              Stream a generated test pattern instead of
+                                   frames from the depth sensor.
+      -rp --replay <file>          Stream frames recorded in <file> in a loop
+                                   instead of frames from the depth sensor.
+      -fps --fps <rate>            Frame rate of the synthetic or replayed
+                                   stream, 0 for as fast as possible.
+                                   [default: 30]
+      -rs --replay-size <WxH>      Resolution of every mode of the synthetic or
+                                   replayed stream.
+)";
+
 /* Available sensors */
 std::vector<std::shared_ptr<aditof::DepthSensorInterface>> depthSensors;
 bool sensors_are_created = false;
-bool clientEngagedWithSensors = false;
-bool isConnectionClosed = true;
-bool gotStream_off = true;
 
 std::unique_ptr<aditof::SensorEnumeratorInterface> sensorsEnumerator;
 
-/* Server only works with one depth sensor */
-std::shared_ptr<aditof::DepthSensorInterface> camDepthSensor;
-std::shared_ptr<aditof::V4lBufferAccessInterface> sensorV4lBufAccess;
-int processedFrameSize;
+// Replay of recorded or synthetic frames, selected on the command line, that
+// stands in for the depth sensors
+static bool replayEnabled = false;
+static ReplayConfig replayConfig;
+
+// Description of the frames produced in the current mode
+struct FrameDescription {
+    uint16_t modeNumber = 0;
+    uint16_t width = 0;
+    uint16_t height = 0;
+    uint16_t planeCount = 0;
+    FrameLayout layout = FRAME_LAYOUT_DEPTH_AB_CONF;
+};
+
+// Plane names of SetFrameContent and Subscribe
+static const std::map<std::string, uint16_t> frameContentNames = {
+    {"depth", FRAME_CONTENT_DEPTH},
+    {"ab", FRAME_CONTENT_AB},
+    {"conf", FRAME_CONTENT_CONF},
+    {"metadata", FRAME_CONTENT_METADATA}};
+
+// Command line settings, applied to the session of every sensor
+static size_t frameRingDepth = 4;
+static DropPolicy frameRingPolicy = DropPolicy::DROP_OLDEST;
+static size_t compressWorkerCount = 2;
+static std::string shmBaseName;
+static size_t maxSubscribers = 0;
+
+// Threads of the streaming pipeline: capture (getFrame, which includes depth
+// compute), process (region, content and encoding) and send, the last one
+// together with the ZMQ I/O thread doing the network writes
+static ThreadPlacement capturePlacement;
+static ThreadPlacement processPlacement;
+static ThreadPlacement sendPlacement;
+
+// Frames the process stage can have ready ahead of the send stage
+static const size_t PIPELINE_DEPTH = 2;
+
+// How long a sensor stays open for the next client after its client went
+// away without HangUp, 0 to close it right away
+static std::chrono::milliseconds warmGrace(30000);
+
+// Ports of the first sensor. Those of sensor k are SENSOR_PORT_STRIDE * k
+// higher, and its shared memory ring name ends in -k.
+static const uint16_t STREAM_PORT = 5555;
+static const uint16_t SUBSCRIBER_BASE_PORT = 5560;
+static const uint16_t SENSOR_PORT_STRIDE = 100;
+
+// ADSD3500 interrupts of every sensor are published on this port as they
+// happen, 0 to only report them to GetInterrupts
+static uint16_t interruptPort = 5557;
 
-static payload::ClientRequest buff_recv;
-static payload::ServerResponse buff_send;
+uint32_t max_send_frames = 10;
+const auto get_frame_timeout =
+    std::chrono::milliseconds(1000); // time to wait for a frame to be captured
+// GetFrame gives up this long after the capture deadline, in case getFrame()
+// itself hangs
+const auto get_frame_wait_margin = std::chrono::milliseconds(500);
 
-//sending frames separately without serializing it
-uint8_t *buff_frame_to_be_captured = nullptr;
-uint8_t *buff_frame_to_send = nullptr;
-unsigned int buff_frame_length;
-bool m_frame_ready = false;
+// Requests and replies are created on this arena and dropped all at once when
+// the reply has been sent. The first block is static and survives Reset(), so
+// typical requests never touch the heap.
+static const size_t RPC_ARENA_BLOCK_SIZE = 256 * 1024;
+static char rpcArenaBlock[RPC_ARENA_BLOCK_SIZE];
 
 static std::map<std::string, api_Values> s_map_api_Values;
 static void Initialize();
 static void data_transaction();
-void invoke_sdk_api(payload::ClientRequest buff_recv);
+void invoke_sdk_api(const payload::ClientRequest &buff_recv,
+                    payload::ServerResponse &buff_send);
 static bool Client_Connected = false;
-static bool no_of_client_connected = false;
+// Connections other than the one of the client operating the camera, which
+// is told apart by the descriptor of its socket
+static int no_of_client_connected = 0;
+static int clientSocketFd = -1;
+static std::chrono::steady_clock::time_point clientConnectedAt;
 bool latest_sent_msg_is_was_buffered = false;
-static std::queue<aditof::Adsd3500Status> adsd3500InterruptsQueue;
-static std::timed_mutex adsd3500InterruptsQueueMutex;
-
-// A test mode that server can be set to. After sending one frame from sensor to host, it will repeat
-// sending the same frame over and over without acquiring any other frame from sensor. This allows
-// testing the network link speed because it eliminates operations on target such as getting the frame
-// from v4l2 interface, passing the frame through depth compute and any deep copying.
-static bool sameFrameEndlessRepeat = false;
-
-// Variables for synchronizing the main thread and the thread responsible for capturing frames from hardware
-std::mutex
-    frameMutex; // used for making sure operations on queue are not done simultaneously by the 2 threads
-std::condition_variable
-    cvGetFrame; // used for threads to signal when to start capturing a frame or when a frame has become available
-bool goCaptureFrame =
-    false; // Flag used by main thread to tell the frame capturing thread to start capturing a frame
-bool frameCaptured =
-    false; // Flag used by frame capturing thread to tell the main thread that a frame has become available
-std::thread
-    frameCaptureThread; // The thread instance for the capturing frame thread
-bool keepCaptureThreadAlive =
-    false; // Flag used by frame capturing thread to know whether to continue or finish
-
-std::unique_ptr<zmq::socket_t> server_socket;
-uint32_t max_send_frames = 10;
-std::atomic<bool> running(false);
-std::atomic<bool> stop_flag(false);
-std::thread data_transaction_thread;
-std::timed_mutex connection_mtx;
-std::mutex mtx;
-std::condition_variable cv;
-std::thread stream_thread;
+
+// Reported by GetServerStats, together with the counters of the sensor
+static const auto serverStartTime = std::chrono::steady_clock::now();
+static LatencyHistogram rpcDuration[API_VALUES_COUNT];
+static uint64_t otherClientRejects = 0;
+
 static std::unique_ptr<zmq::context_t> context;
 static std::unique_ptr<zmq::socket_t> server_cmd;
 static std::unique_ptr<zmq::socket_t> monitor_socket;
-bool send_async = false;
-const auto get_frame_timeout =
-    std::chrono::milliseconds(1000); // time to wait for a frame to be captured
+static std::unique_ptr<zmq::socket_t> interrupt_pub;
+
+// Written by the interrupt callbacks to wake up the command thread
+static int interruptEventFd = -1;
+static std::atomic<bool> interruptPublisherRunning{false};
+
+static int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+/**
+ * @brief An ADSD3500 interrupt, as queued by the callback of the sensor.
+ */
+struct InterruptEvent {
+    int32_t status = 0; // aditof::Adsd3500Status
+    int64_t timestamp = 0;
+};
+
+/**
+ * @brief A frame made ready to send by the process stage: the payload, which
+ * holds its own reference, and the capture details of its header.
+ */
+struct PreparedFrame {
+    FramePool::Buffer *payload = nullptr;
+    size_t offset = 0;
+    size_t length = 0;
+    uint64_t captureIndex = 0;
+    int64_t captureTimestamp = 0;
+    int64_t enqueueTimestamp = 0;
+};
+
+/**
+ * @brief Everything needed to stream one depth sensor: the sensor, its
+ * capture and stream threads, frame buffers, encoders and stream endpoint.
+ *
+ * Requests carry the index of the sensor they are for (sensor_index, 0 by
+ * default) and are served by its session, so several sensors stream at once
+ * from one process, each on its own threads. Only the command socket and the
+ * client connection are shared.
+ */
+struct SensorSession {
+    explicit SensorSession(size_t sensorIndex);
+    ~SensorSession();
+
+    SensorSession(const SensorSession &) = delete;
+    SensorSession &operator=(const SensorSession &) = delete;
+
+    // Serves a request for this sensor
+    void handle_request(api_Values api, const payload::ClientRequest &buff_recv,
+                        payload::ServerResponse &buff_send);
+    void execute_request(api_Values api,
+                         const payload::ClientRequest &buff_recv,
+                         payload::ServerResponse &buff_send);
+    void submit_job(api_Values api, const payload::ClientRequest &buff_recv,
+                    payload::ServerResponse &buff_send);
+    void describe_job(const payload::ClientRequest &buff_recv,
+                      payload::ServerResponse &buff_send);
+    void cancel_jobs();
+    std::unique_lock<std::mutex> lock_sensor();
+    bool check_request_available(api_Values api,
+                                 const payload::ClientRequest &buff_recv,
+                                 payload::ServerResponse &buff_send);
+    void attach_sensor(std::shared_ptr<aditof::DepthSensorInterface> sensor);
+    void park();
+    void rebind();
+    void reset_client_settings();
+    void fill_server_stats(payload::ServerStats *stats);
+    void set_interrupt_flag(payload::ServerResponse &buff_send);
+    void publish_interrupts();
+    aditof::Status parse_frame_region(const payload::ClientRequest &buff_recv,
+                                      int first, FrameRegion &region);
+    aditof::Status build_capabilities(payload::SensorCapabilities &caps,
+                                      bool &complete);
+    void describe_capabilities(payload::ServerResponse &buff_send);
+    aditof::Status run_adsd3500_op(const payload::Adsd3500Op &op,
+                                   payload::Adsd3500OpResult &result);
+
+    size_t frame_pool_size() const;
+    uint64_t number_captured_frame(const FramePool::Buffer *frame,
+                                   uint64_t read);
+    void drain_frame_ring();
+    bool take_captured_frame();
+    void prepare_frame_region();
+    FramePool::Buffer *transform_frame(const FramePool::Buffer *frame);
+    void send_whole_frames();
+    void prepare_frame_content();
+    bool select_frame_content(FramePool::Buffer *&payload, size_t &offset,
+                              size_t &length);
+    bool prepare_frame_compression();
+    FramePool::Buffer *compress_frame(const uint8_t *data, size_t &length);
+    bool prepare_frame_packing(const payload::ClientRequest &request);
+    FramePool::Buffer *pack_frame(const uint8_t *data, size_t &length);
+    bool prepare_frame_tile_delta(const payload::ClientRequest &request);
+    FramePool::Buffer *tile_delta_frame(const uint8_t *data, size_t &length);
+    FrameEncoding current_frame_encoding() const;
+    FramePool::Buffer *encode_frame(const uint8_t *data, size_t &length);
+    size_t max_payload_size() const;
+    bool prepare_shm_transport();
+    bool send_frame_zmq(const FrameHeader &header, FramePool::Buffer *payload,
+                        size_t offset, size_t length);
+    bool prepare_frame(FramePool::Buffer *frame, PreparedFrame &prepared);
+    bool transmit_frame(PreparedFrame &prepared);
+    bool send_frame(FramePool::Buffer *frame);
+    void close_zmq_connection();
+    void process_captured_frames();
+    void stream_zmq_frame();
+    void start_stream_thread();
+    void stop_stream_thread();
+    bool wait_for_sensor_frame(std::chrono::milliseconds timeout);
+    void superviseFrameCapture();
+    void captureFrameFromHardware();
+    void report_capture_failure();
+    void describe_frame(const aditof::DepthSensorModeDetails &details);
+    void reserve_frame_buffers();
+    aditof::Status allocate_frame_buffers(size_t frameSize);
+    void cleanup_sensors();
+
+    const size_t index;
+    const uint16_t streamPort;
+    const std::string shmName;
+
+    // The sensor and, when it exposes them, its V4L2 buffers. Streamed
+    // frames come from frameSource: the sensor or a replay.
+    std::shared_ptr<aditof::DepthSensorInterface> camDepthSensor;
+    std::shared_ptr<aditof::V4lBufferAccessInterface> sensorV4lBufAccess;
+    std::shared_ptr<FrameSource> frameSource;
+    bool clientEngagedWithSensors = false;
+    bool isConnectionClosed = true;
+    bool gotStream_off = true;
+    int processedFrameSize = 0;
+    FrameDescription currentFrame;
+
+    // Warm session: when the client goes away without HangUp the sensor
+    // stays open, in its mode and with depth compute initialized, for
+    // warmGrace. The next client to use the sensor picks it up, and setting
+    // the same mode and depth compute data again is then skipped until
+    // Start.
+    bool warm = false;
+    bool rebound = false;
+    std::chrono::steady_clock::time_point warmSince;
+    int activeMode = -1;
+    std::string depthComputeIni;
+    std::string depthComputeCal;
+    std::atomic<uint64_t> warmRebinds{0};
+    std::atomic<uint64_t> warmExpired{0};
+
+    // Time from the client connection to its first frame, for a session
+    // picked up warm or opened anew. Set at Open, before streaming.
+    std::atomic<bool> firstFramePending{false};
+    bool firstFrameWarm = false;
+    std::chrono::steady_clock::time_point firstFrameFrom;
+    LatencyHistogram coldFirstFrameDuration;
+    LatencyHistogram warmFirstFrameDuration;
+
+    // Modes, controls and versions of the sensor for GetSensorCapabilities,
+    // kept once they could all be read. They only change when the firmware
+    // or the CCB is written, which is done with burst mode payload writes.
+    std::unique_ptr<payload::SensorCapabilities> capabilities;
+    std::atomic<uint64_t> capabilitiesBuilt{0};
+    std::atomic<uint64_t> capabilitiesCached{0};
+
+    // Requests run in the background when the client asks, one at a time
+    // and in order by jobWorker. While one is queued or running, requests
+    // that use the sensor, Stop included, are answered BUSY.
+    JobTable jobs;
+    WorkerPool jobWorker;
+    LatencyHistogram jobQueuedDuration;
+    LatencyHistogram jobDuration;
+    std::atomic<uint64_t> jobsRun{0};
+
+    // Calls into the sensor are made with lock_sensor() held: by the capture
+    // thread for each frame, by the command thread and jobWorker for each
+    // request. Queuing on sensorTurn first makes them take turns, so a
+    // capture running back to back doesn't keep the others waiting.
+    std::mutex sensorMutex;
+    std::mutex sensorTurn;
+
+    // Commands run by Adsd3500Batch requests
+    std::atomic<uint64_t> adsd3500Batches{0};
+    std::atomic<uint64_t> adsd3500BatchOps{0};
+
+    // Region of the image and decimation asked for with SetFrameRegion. At
+    // Start the frames of the current mode are transformed, on the sending
+    // thread and the compression workers, into buffers of transformPool.
+    FrameRegion frameRegion;
+    bool regionEnabled = false;
+    FrameTransform frameTransform;
+    FramePool transformPool;
+    LatencyHistogram transformDuration;
+
+    // Planes the client asked for with SetFrameContent, 0 for whole frames.
+    // At Start they are turned into the slices of the captured frame to
+    // send: a single slice goes out without copying, several are packed into
+    // a buffer of packPool.
+    uint16_t frameContentMask = 0;
+    SentFrame sentFrame;
+    FramePool packPool;
+
+    // Lossless compression of the stream, chosen by the client at Start. The
+    // sender encodes each frame together with the workers into a buffer of
+    // encodedPool, which ZMQ then sends without copying.
+    bool compressFrames = false;
+    FrameCodec frameCodec;
+    FramePool encodedPool;
+    WorkerPool compressWorkers;
+    LatencyHistogram compressDuration;
+    std::atomic<uint64_t> framesCompressed{0};
+    std::atomic<uint64_t> compressBytesIn{0};
+    std::atomic<uint64_t> compressBytesOut{0};
+
+    // Tile-delta streaming: only the tiles that changed since the last frame
+    // sent to the client, with periodic keyframes. Tiles are compared by the
+    // sender and the workers, and the result also goes in encodedPool.
+    bool tileDeltaFrames = false;
+    bool tileDeltaResync = false; // a frame was lost, send stage waits for
+                                  // a keyframe
+    TileDeltaEncoder tileEncoder;
+    LatencyHistogram tileDeltaDuration;
+    std::atomic<uint64_t> tilesSent{0};
+    std::atomic<uint64_t> tilesTotal{0};
+    std::atomic<uint64_t> keyframesSent{0};
+
+    // 12-bit packing of some planes, the cheaper alternative to compression
+    // a client can ask for at Start. Packed frames also go in encodedPool.
+    bool packFrames = false;
+    FramePacker framePacker;
+    LatencyHistogram packDuration;
+    std::atomic<uint64_t> framesPacked{0};
+
+    // Shared-memory transport for clients on the same machine, chosen at
+    // Start. Frames then go to shmRing instead of the stream port.
+    bool shmTransport = false;
+    ShmFrameRing shmRing;
+
+    // Clients watching the stream of the client that operates the camera.
+    // Every captured frame is offered to them by the capture thread.
+    FrameFanout frameFanout;
+
+    // Per-frame header sent in front of each frame on the stream socket
+    bool frameHeaderEnabled = false;
+    std::atomic<uint64_t> frameSequence{0};
+
+    //sending frames separately without serializing it
+    FramePool framePool;
+    FramePool::Buffer *buff_frame_to_send = nullptr;
+    unsigned int buff_frame_length = 0;
+    bool m_frame_ready = false;
+
+    // Captured frames wait here for the sender, so a slow network send never
+    // holds up reading the sensor. Depth and drop policy come from the
+    // command line.
+    FrameRing<FramePool::Buffer> frameRing;
+    std::atomic<uint64_t> framesDroppedNoBuffer{
+        0}; // frames read from the sensor while every pool buffer was in use
+
+    // Interrupts of the ADSD3500. The callback queues them without locking
+    // and wakes up the interrupt publisher thread, which publishes them and
+    // hands them to the command thread in pendingInterrupts, kept until the
+    // client asks for them.
+    aditof::SensorInterruptCallback callback;
+    MpscRing<InterruptEvent> interruptQueue;
+    std::atomic<uint64_t> interruptsDropped{0}; // queue full
+    std::atomic<uint64_t> interruptsPublished{0};
+    uint64_t interruptsDroppedReported = 0; // publisher thread only
+    std::mutex interruptMutex;
+    std::deque<aditof::Adsd3500Status> pendingInterrupts; // interruptMutex
+
+    // A test mode that server can be set to. After sending one frame from
+    // sensor to host, it will repeat sending the same frame over and over
+    // without acquiring any other frame from sensor. This allows testing the
+    // network link speed because it eliminates operations on target such as
+    // getting the frame from v4l2 interface, passing the frame through depth
+    // compute and any deep copying.
+    bool sameFrameEndlessRepeat = false;
+
+    // Variables for synchronizing the main thread and the thread responsible
+    // for capturing frames from hardware
+    std::mutex frameMutex; // used for making sure operations on queue are
+                           // not done simultaneously by the 2 threads
+    std::condition_variable
+        cvGetFrame; // used for threads to signal when to start capturing a
+                    // frame or when a frame has become available
+    bool goCaptureFrame = false; // Flag used by main thread to tell the frame
+                                 // capturing thread to start capturing a frame
+    bool captureFailed = false;  // Set by the capture thread when the frame
+                                 // it was asked for could not be captured
+    std::atomic<uint64_t> getFrameFailures{0}; // GetFrame that sent no frame
+    std::atomic<bool> captureFreeRunning{
+        false}; // Flag used while streaming asynchronously, the frame
+                // capturing thread then captures back to back
+    std::thread frameCaptureThread; // The thread instance for the capturing
+                                    // frame thread
+    bool keepCaptureThreadAlive =
+        false; // Flag used by frame capturing thread to know whether to
+               // continue or finish
+    std::thread captureWatchdogThread; // Reports getFrame() calls that do
+                                       // not return in time
+    std::condition_variable cvCaptureWatchdog;
+
+    // Capture timing, logged when streaming stops
+    LatencyHistogram frameWaitDuration; // waiting for the sensor to have a
+                                        // frame
+    LatencyHistogram getFrameDuration;  // getFrame() call, incl. depth compute
+    std::atomic<int64_t> getFrameStartNs{0}; // 0 while no getFrame() is running
+    std::atomic<uint64_t> captureCounter{0}; // frames read since Start
+    bool captureNumbered = false; // the capture thread numbers the frames
+    uint64_t lastCaptureIndex = 0; // as the sensor did, reset at Start
+    uint32_t lastSensorFrame = 0;
+
+    // Reported by GetServerStats, together with the pool, ring and capture
+    // counters
+    std::atomic<uint64_t> framesCaptured{0};
+    std::atomic<uint64_t> captureFailures{0};
+    std::atomic<uint64_t> framesSent{0};
+    std::atomic<uint64_t> framesDroppedBusyClient{0};
+    std::atomic<uint64_t> bytesSent{0};
+    std::atomic<size_t> frameRingPeak{0};
+    LatencyHistogram sendDuration; // handing a frame to the stream socket
+    std::atomic<uint64_t> captureTimeouts{0};
+    std::atomic<uint64_t> captureStalls{0};
+
+    std::unique_ptr<zmq::socket_t> server_socket;
+    std::atomic<bool> running{false};
+    std::atomic<bool> stop_flag{false};
+    std::mutex mtx;
+    std::condition_variable cv;
+    std::thread stream_thread;
+    bool send_async = false;
+
+    // Process stage of asynchronous streaming, between the capture ring and
+    // the stream thread. Prepared frames are queued under frameMutex.
+    std::thread processThread;
+    std::deque<PreparedFrame> preparedFrames;
+    LatencyHistogram processDuration;
+
+    // Credit-based delivery (GrantFrameCredits): the stream thread sends a
+    // frame only while the client has credits left, one credit per frame. The
+    // client grants more as it consumes frames, so at most max_send_frames
+    // are in flight and frames wait in the capture ring instead of being
+    // dropped by the socket. Credits change under frameMutex and cvGetFrame
+    // is notified on grants.
+    bool frameCreditsEnabled = false;
+    std::atomic<uint32_t> frameCredits{0};
+    std::atomic<uint64_t> creditStalls{0}; // sender had a frame but no credit
+};
+
+// One session per sensor found, in the order of depthSensors. Sessions stay
+// until the server exits so that subscribers outlive a client.
+static std::vector<std::unique_ptr<SensorSession>> sessions;
+// Taken to add sessions, as the interrupt publisher goes through them
+static std::mutex sessionsMutex;
+
+SensorSession::SensorSession(size_t sensorIndex)
+    : index(sensorIndex),
+      streamPort(static_cast<uint16_t>(STREAM_PORT +
+                                        SENSOR_PORT_STRIDE * sensorIndex)),
+      shmName(sensorIndex ? shmBaseName + "-" + std::to_string(sensorIndex)
+                          : shmBaseName) {
+    frameRing.reset(frameRingDepth, frameRingPolicy);
+    frameFanout.configure(*context, maxSubscribers,
+                          static_cast<uint16_t>(SUBSCRIBER_BASE_PORT +
+                                                SENSOR_PORT_STRIDE * index));
+    // Called by the sensor driver, so it neither locks nor allocates
+    callback = [this](aditof::Adsd3500Status status) {
+        InterruptEvent event;
+        event.status = static_cast<int32_t>(status);
+        event.timestamp = wall_clock_ns();
+        if (!interruptQueue.push(event)) {
+            ++interruptsDropped;
+        }
+        if (interruptEventFd >= 0) {
+            uint64_t one = 1;
+            ssize_t written = write(interruptEventFd, &one, sizeof(one));
+            (void)written;
+        }
+    };
+}
+
+SensorSession::~SensorSession() {
+    cancel_jobs();
+    jobWorker.stop();
+    stop_stream_thread();
+    if (!isConnectionClosed) {
+        std::unique_lock<std::mutex> sensor = lock_sensor();
+        close_zmq_connection();
+    }
+    cleanup_sensors();
+    frameFanout.shutdown();
+}
+
+// Buffers needed to keep the pipeline busy: one being captured, a full ring,
+// one held by the sender and up to max_send_frames queued in ZMQ, plus one
+// spare and the ones subscribers can hold.
+size_t SensorSession::frame_pool_size() const {
+    return frameRing.capacity() + max_send_frames + 3 +
+           frameFanout.bufferBudget();
+}
+
+// Numbers a captured frame after the frame number of the ADSD3500 in the
+// metadata at the start of the AB plane, so that frames the sensor or the
+// driver skipped leave a gap like the ones dropped here. The number is
+// carried on past 32 bits, and a number going back (the sensor restarted, a
+// replay looped) is taken as the next frame. PCM frames have no metadata and
+// are numbered in the order they are read. Called by the capture thread with
+// read, the frames read before this one since Start.
+uint64_t SensorSession::number_captured_frame(const FramePool::Buffer *frame,
+                                              uint64_t read) {
+    const size_t metadata = static_cast<size_t>(currentFrame.width) *
+                            currentFrame.height * sizeof(uint16_t);
+    if (currentFrame.layout == FRAME_LAYOUT_PCM ||
+        metadata + FRAME_METADATA_SIZE > buff_frame_length) {
+        return read;
+    }
+
+    uint32_t number;
+    memcpy(&number, frame->data + metadata + FRAME_METADATA_FRAME_NUMBER,
+           sizeof(number));
+    if (!captureNumbered) {
+        lastCaptureIndex = number;
+        captureNumbered = true;
+    } else {
+        const uint32_t step = number - lastSensorFrame;
+        lastCaptureIndex += step && step < 0x80000000u ? step : 1;
+    }
+    lastSensorFrame = number;
+    return lastCaptureIndex;
+}
+
+void SensorSession::drain_frame_ring() {
+    while (FramePool::Buffer *frame = frameRing.pop()) {
+        framePool.release(frame);
+    }
+}
+
+// Takes the oldest captured frame out of the ring and makes it the frame
+// being sent. Returns false if there was no usable frame.
+bool SensorSession::take_captured_frame() {
+    FramePool::Buffer *frame = frameRing.pop();
+    if (!frame) {
+        return false;
+    }
+
+    if (frame->generation != framePool.generation()) {
+        // Captured before a mode switch
+        framePool.release(frame);
+        return false;
+    }
+
+    // The previous frame may still be queued in ZMQ which holds its own
+    // reference, so this only gives up ours.
+    if (buff_frame_to_send) {
+        framePool.release(buff_frame_to_send);
+    }
+    buff_frame_to_send = frame;
+
+    return true;
+}
+
+// Sets up cropping and decimating the frames of the current mode to the
+// region selected by the client. Frames are sent whole if it doesn't fit.
+void SensorSession::prepare_frame_region() {
+    regionEnabled = false;
+    if (!frameRegion.width && frameRegion.decimation == 1) {
+        return;
+    }
+    if (frameTransform.configure(currentFrame.layout, currentFrame.width,
+                                 currentFrame.height, currentFrame.planeCount,
+                                 frameRegion) != aditof::Status::OK) {
+        LOG(WARNING) << "Frame region does not fit this mode, sending whole "
+                        "frames";
+        return;
+    }
+
+    // Enough for a full send queue, the frame being transformed and a spare
+    if (transformPool.bufferSize() != frameTransform.outputSize()) {
+        aditof::Status status = transformPool.allocate(
+            frameTransform.outputSize(), max_send_frames + 2);
+        if (status != aditof::Status::OK) {
+            LOG(WARNING) << "Sending whole frames";
+            return;
+        }
+    }
+
+    compressWorkers.start(compressWorkerCount);
+    regionEnabled = true;
+}
+
+// Transforms frame to the selected region. Returns the transformed buffer
+// holding one reference, or nullptr if the client has not taken enough of the
+// previous ones.
+FramePool::Buffer *
+SensorSession::transform_frame(const FramePool::Buffer *frame) {
+    FramePool::Buffer *transformed =
+        transformPool.acquire(std::chrono::milliseconds(FRAME_TIMEOUT));
+    if (!transformed) {
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    compressWorkers.parallelFor(frameTransform.bandCount(), [&](size_t i) {
+        frameTransform.apply(frame->data, transformed->data, i);
+    });
+    frameTransform.finish(frame->data, transformed->data);
+    transformDuration.record(std::chrono::steady_clock::now() - start);
+
+    return transformed;
+}
+
+// Frames of the current mode as produced by the region stage
+void SensorSession::send_whole_frames() {
+    sentFrame = SentFrame();
+    sentFrame.layout = currentFrame.layout;
+    sentFrame.planeCount = currentFrame.planeCount;
+    if (regionEnabled) {
+        sentFrame.width = frameTransform.outputWidth();
+        sentFrame.height = frameTransform.outputHeight();
+        sentFrame.length = frameTransform.outputSize();
+    } else {
+        sentFrame.width = currentFrame.width;
+        sentFrame.height = currentFrame.height;
+        sentFrame.length = buff_frame_length;
+    }
+}
+
+// Works out what is sent of the frames of the current mode from the planes
+// selected by the client. Modes without separate planes are sent whole.
+void SensorSession::prepare_frame_content() {
+    send_whole_frames();
+    if (!describeFrameContent(sentFrame.layout, sentFrame.width,
+                              sentFrame.height, sentFrame.planeCount,
+                              sentFrame.length, frameContentMask, sentFrame)) {
+        LOG(WARNING) << "Selected frame content is not available in this "
+                        "mode, sending whole frames";
+        return;
+    }
+
+    // Enough for a full send queue, the frame being packed and a spare
+    if (sentFrame.slices.size() > 1 &&
+        packPool.bufferSize() != sentFrame.length) {
+        if (packPool.allocate(sentFrame.length, max_send_frames + 2) !=
+            aditof::Status::OK) {
+            LOG(WARNING) << "Sending whole frames";
+            send_whole_frames();
+        }
+    }
+}
+
+// Points payload, offset and length at the part of frame the client asked
+// for. Planes that are not next to each other are copied into a buffer of
+// packPool, which is then returned holding one reference.
+bool SensorSession::select_frame_content(FramePool::Buffer *&payload,
+                                         size_t &offset, size_t &length) {
+    if (sentFrame.slices.empty()) {
+        return true;
+    }
+    if (sentFrame.slices.size() == 1) {
+        offset = sentFrame.slices.front().offset;
+        length = sentFrame.slices.front().length;
+        return true;
+    }
+
+    FramePool::Buffer *packed =
+        packPool.acquire(std::chrono::milliseconds(FRAME_TIMEOUT));
+    if (!packed) {
+        return false;
+    }
+    gatherFrameContent(sentFrame, payload->data, packed->data);
+    payload = packed;
+    offset = 0;
+    length = sentFrame.length;
+    return true;
+}
+
+// Sets up compression of the frames of the current mode. Returns false if
+// they can't be compressed, in which case they are sent raw.
+bool SensorSession::prepare_frame_compression() {
+    if (frameCodec.configure(sentFrame.layout, sentFrame.width,
+                             sentFrame.height, sentFrame.planeCount,
+                             sentFrame.length) != aditof::Status::OK) {
+        LOG(WARNING) << "Frames of this mode can't be compressed";
+        return false;
+    }
+
+    // Enough for a full send queue, the frame being encoded and a spare
+    if (encodedPool.bufferSize() != frameCodec.maxEncodedSize()) {
+        aditof::Status status = encodedPool.allocate(
+            frameCodec.maxEncodedSize(), max_send_frames + 2);
+        if (status != aditof::Status::OK) {
+            return false;
+        }
+    }
+
+    compressWorkers.start(compressWorkerCount);
+    return true;
+}
+
+// Encodes length bytes of data on the sending thread and the workers.
+// Returns the encoded buffer holding one reference, or nullptr if the client
+// has not taken enough of the previous ones.
+FramePool::Buffer *SensorSession::compress_frame(const uint8_t *data,
+                                                 size_t &length) {
+    FramePool::Buffer *encoded =
+        encodedPool.acquire(std::chrono::milliseconds(FRAME_TIMEOUT));
+    if (!encoded) {
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    compressWorkers.parallelFor(frameCodec.segmentCount(), [&](size_t i) {
+        frameCodec.encodeSegment(data, i, encoded->data);
+    });
+    compressBytesIn += length;
+    length = frameCodec.finish(encoded->data);
+    compressDuration.record(std::chrono::steady_clock::now() - start);
+
+    ++framesCompressed;
+    compressBytesOut += length;
+    return encoded;
+}
+
+// Sets up packing the planes named in the Start request. Returns false if
+// none of them can be packed, in which case frames are sent as they are.
+bool SensorSession::prepare_frame_packing(
+    const payload::ClientRequest &request) {
+    uint16_t content = 0;
+    for (int i = 0; i < request.packed_planes_size(); ++i) {
+        auto plane = frameContentNames.find(request.packed_planes(i));
+        if (plane == frameContentNames.end()) {
+            LOG(WARNING) << "Unknown frame content: "
+                         << request.packed_planes(i);
+            continue;
+        }
+        content |= plane->second;
+    }
+    if (!content) {
+        return false;
+    }
+
+    if (framePacker.configure(sentFrame.layout, sentFrame.width,
+                              sentFrame.height, sentFrame.length,
+                              content) != aditof::Status::OK) {
+        LOG(WARNING) << "Frames of this mode can't be packed";
+        return false;
+    }
+
+    // Enough for a full send queue, the frame being packed and a spare
+    if (encodedPool.bufferSize() != framePacker.packedSize()) {
+        aditof::Status status = encodedPool.allocate(
+            framePacker.packedSize(), max_send_frames + 2);
+        if (status != aditof::Status::OK) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Packs a frame on the sending thread. Returns the packed buffer holding one
+// reference, or nullptr if the client has not taken enough of the previous
+// ones.
+FramePool::Buffer *SensorSession::pack_frame(const uint8_t *data,
+                                             size_t &length) {
+    FramePool::Buffer *packed =
+        encodedPool.acquire(std::chrono::milliseconds(FRAME_TIMEOUT));
+    if (!packed) {
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    framePacker.pack(data, packed->data);
+    length = framePacker.packedSize();
+    packDuration.record(std::chrono::steady_clock::now() - start);
+
+    ++framesPacked;
+    return packed;
+}
+
+// Sets up tile-delta streaming as asked for in the Start request. Returns
+// false if frames of the current mode can't be cut in tiles.
+bool SensorSession::prepare_frame_tile_delta(
+    const payload::ClientRequest &request) {
+    if (!request.tile_delta()) {
+        return false;
+    }
+    if (request.tile_size() > UINT16_MAX ||
+        request.tile_threshold() > UINT16_MAX ||
+        tileEncoder.configure(sentFrame.layout, sentFrame.width,
+                              sentFrame.height, sentFrame.planeCount,
+                              sentFrame.length,
+                              static_cast<uint16_t>(request.tile_size()),
+                              static_cast<uint16_t>(request.tile_threshold()),
+                              request.keyframe_interval()) !=
+            aditof::Status::OK) {
+        LOG(WARNING) << "Frames of this mode can't be sent as tiles";
+        return false;
+    }
+
+    // Enough for a full send queue, the frame being encoded and a spare
+    if (encodedPool.bufferSize() != tileEncoder.maxEncodedSize()) {
+        aditof::Status status = encodedPool.allocate(
+            tileEncoder.maxEncodedSize(), max_send_frames + 2);
+        if (status != aditof::Status::OK) {
+            return false;
+        }
+    }
+
+    compressWorkers.start(compressWorkerCount);
+    return true;
+}
+
+// Encodes the tiles of a frame that changed. Returns the encoded buffer
+// holding one reference, or nullptr if the client has not taken enough of the
+// previous ones.
+FramePool::Buffer *SensorSession::tile_delta_frame(const uint8_t *data,
+                                                   size_t &length) {
+    FramePool::Buffer *encoded =
+        encodedPool.acquire(std::chrono::milliseconds(FRAME_TIMEOUT));
+    if (!encoded) {
+        return nullptr;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    if (tileEncoder.begin()) {
+        ++keyframesSent;
+    } else {
+        compressWorkers.parallelFor(
+            tileEncoder.tileRowCount(),
+            [&](size_t row) { tileEncoder.compareTileRow(data, row); });
+    }
+    length = tileEncoder.finish(data, encoded->data);
+    tileDeltaDuration.record(std::chrono::steady_clock::now() - start);
+
+    tilesSent += tileEncoder.changedTiles();
+    tilesTotal += tileEncoder.tileCount();
+    return encoded;
+}
+
+FrameEncoding SensorSession::current_frame_encoding() const {
+    if (compressFrames) {
+        return FRAME_ENCODING_DELTA_PACK;
+    }
+    if (tileDeltaFrames) {
+        return FRAME_ENCODING_TILE_DELTA;
+    }
+    return packFrames ? FRAME_ENCODING_PACK12 : FRAME_ENCODING_RAW;
+}
+
+// Encodes length bytes of data as chosen at Start
+FramePool::Buffer *SensorSession::encode_frame(const uint8_t *data,
+                                               size_t &length) {
+    switch (current_frame_encoding()) {
+    case FRAME_ENCODING_DELTA_PACK:
+        return compress_frame(data, length);
+    case FRAME_ENCODING_TILE_DELTA:
+        return tile_delta_frame(data, length);
+    case FRAME_ENCODING_PACK12:
+        return pack_frame(data, length);
+    default:
+        return nullptr;
+    }
+}
+
+// Largest payload send_frame() can produce in the current mode
+size_t SensorSession::max_payload_size() const {
+    switch (current_frame_encoding()) {
+    case FRAME_ENCODING_DELTA_PACK:
+        return frameCodec.maxEncodedSize();
+    case FRAME_ENCODING_TILE_DELTA:
+        return tileEncoder.maxEncodedSize();
+    case FRAME_ENCODING_PACK12:
+        return framePacker.packedSize();
+    default:
+        return sentFrame.length;
+    }
+}
+
+// Sets up the shared memory ring for frames of the current mode. Returns
+// false if it can't be created, in which case frames go to the stream port.
+bool SensorSession::prepare_shm_transport() {
+    // As many frames as the socket would queue, plus the ones being read
+    if (shmRing.create(shmName, max_send_frames + 2, max_payload_size()) !=
+        aditof::Status::OK) {
+        LOG(WARNING) << "Unable to create shared memory " << shmName
+                     << ", sending frames on port " << streamPort;
+        return false;
+    }
+    return true;
+}
+
+// Queues a frame on the stream socket, preceded by its header if the client
+// asked for one. Both parts are queued together or not at all.
+bool SensorSession::send_frame_zmq(const FrameHeader &header,
+                                   FramePool::Buffer *payload, size_t offset,
+                                   size_t length) {
+    if (frameHeaderEnabled) {
+        zmq::message_t headerMessage(&header, sizeof(header));
+        if (!server_socket->send(headerMessage, zmq::send_flags::sndmore)) {
+            return false;
+        }
+    }
+
+    // The message keeps its own reference to the payload
+    zmq::message_t message = payload->pool->toMessage(payload, length, offset);
+    return server_socket->send(message, zmq::send_flags::none).has_value();
+}
+
+// Process stage: transforms, selects and encodes a captured frame. The
+// prepared payload holds a reference of its own, so frame can be released.
+bool SensorSession::prepare_frame(FramePool::Buffer *frame,
+                                  PreparedFrame &prepared) {
+    auto start = std::chrono::steady_clock::now();
+
+    // Buffers other than frame are owned here until handed over in prepared
+    FramePool::Buffer *payload = frame;
+    size_t offset = 0;
+    size_t length = buff_frame_length;
+    if (regionEnabled) {
+        payload = transform_frame(frame);
+        if (!payload) {
+            return false;
+        }
+        length = frameTransform.outputSize();
+    }
+    FramePool::Buffer *selected = payload;
+    bool selectedOk = select_frame_content(selected, offset, length);
+    if (selected != payload || !selectedOk) {
+        if (payload != frame) {
+            payload->pool->release(payload);
+        }
+        if (!selectedOk) {
+            return false;
+        }
+        payload = selected;
+    }
+    if (current_frame_encoding() != FRAME_ENCODING_RAW) {
+        FramePool::Buffer *encoded =
+            encode_frame(payload->data + offset, length);
+        if (payload != frame) {
+            payload->pool->release(payload);
+        }
+        if (!encoded) {
+            return false;
+        }
+        payload = encoded;
+        offset = 0;
+    }
+    if (payload == frame) {
+        frame->pool->retain(frame);
+    }
+
+    prepared.payload = payload;
+    prepared.offset = offset;
+    prepared.length = length;
+    prepared.captureIndex = frame->captureIndex;
+    prepared.captureTimestamp = frame->captureTimestamp;
+
+    processDuration.record(std::chrono::steady_clock::now() - start);
+    return true;
+}
+
+// Send stage: hands a prepared frame to the transport the client chose and
+// releases it
+// Whether an encoded tile-delta frame carries every tile
+static bool is_tile_delta_keyframe(const uint8_t *data, size_t length) {
+    TileDeltaHeader header;
+    if (length < sizeof(header)) {
+        return false;
+    }
+    memcpy(&header, data, sizeof(header));
+    return header.flags & TILE_DELTA_KEYFRAME;
+}
+
+bool SensorSession::transmit_frame(PreparedFrame &prepared) {
+    FramePool::Buffer *payload = prepared.payload;
+    if (tileDeltaFrames && tileDeltaResync &&
+        !is_tile_delta_keyframe(payload->data + prepared.offset,
+                                prepared.length)) {
+        // Encoded against what the client didn't get
+        payload->pool->release(payload);
+        prepared.payload = nullptr;
+        return false;
+    }
+
+    uint64_t sequence = frameSequence++;
+
+    auto start = std::chrono::steady_clock::now();
+    FrameHeader header = {};
+    header.magic = FRAME_HEADER_MAGIC;
+    header.version = FRAME_HEADER_VERSION;
+    header.headerSize = sizeof(FrameHeader);
+    header.sequence = sequence;
+    header.captureIndex = prepared.captureIndex;
+    header.captureTimestamp = prepared.captureTimestamp;
+    header.enqueueTimestamp = prepared.enqueueTimestamp;
+    header.sendTimestamp = wall_clock_ns();
+    header.payloadSize = static_cast<uint32_t>(prepared.length);
+    header.modeNumber = currentFrame.modeNumber;
+    header.payloadLayout = sentFrame.layout;
+    header.width = sentFrame.width;
+    header.height = sentFrame.height;
+    header.planeCount = sentFrame.planeCount;
+    header.encoding = current_frame_encoding();
+
+    size_t bytes = prepared.length;
+    bool sent = false;
+    if (shmTransport) {
+        // Slots always carry the header
+        sent = shmRing.publish(header, payload->data + prepared.offset,
+                               prepared.length);
+        bytes += sizeof(header);
+    } else {
+        sent = send_frame_zmq(header, payload, prepared.offset,
+                              prepared.length);
+        bytes += frameHeaderEnabled ? sizeof(header) : 0;
+    }
+    payload->pool->release(payload);
+    prepared.payload = nullptr;
+
+    auto end = std::chrono::steady_clock::now();
+    sendDuration.record(end - start);
+    if (sent && firstFramePending.exchange(false)) {
+        (firstFrameWarm ? warmFirstFrameDuration : coldFirstFrameDuration)
+            .record(end - firstFrameFrom);
+    }
+    if (sent) {
+        ++framesSent;
+        bytesSent += bytes;
+        tileDeltaResync = false;
+    } else if (tileDeltaFrames) {
+        // The client is missing tiles now, and so are the frames already
+        // encoded after this one
+        tileEncoder.requestKeyframe();
+        tileDeltaResync = true;
+    }
+
+    return sent;
+}
+
+// Sends a frame to the client on the transport it chose, both stages on the
+// calling thread
+bool SensorSession::send_frame(FramePool::Buffer *frame) {
+    PreparedFrame prepared;
+    if (!prepare_frame(frame, prepared)) {
+        return false;
+    }
+    prepared.enqueueTimestamp = wall_clock_ns();
+    return transmit_frame(prepared);
+}
 
 struct clientData {
     bool hasFragments;
     std::vector<char> data;
 };
 
-static void close_zmq_connection() {
+// Called with lock_sensor() held, the capture thread may be running
+void SensorSession::close_zmq_connection() {
 
     // Stop the sensor if not already stopped
-    if (!gotStream_off && camDepthSensor) {
-        aditof::Status status = camDepthSensor->stop();
+    if (!gotStream_off && frameSource) {
+        aditof::Status status = frameSource->stop();
         gotStream_off = (status == aditof::Status::OK);
     }
 
@@ -146,17 +1203,72 @@ static void close_zmq_connection() {
     isConnectionClosed = true;
 }
 
-void stream_zmq_frame() {
+// Context of the stream sockets of every sensor. Its I/O thread does the
+// network writes of the send stage and is placed like it.
+static zmq::context_t &stream_context() {
+    static zmq::context_t zmq_context(1);
+    static const aditof::Status placed =
+        placeZmqIoThreads(zmq_context.handle(), sendPlacement);
+    (void)placed;
+    return zmq_context;
+}
+
+// Process stage of asynchronous streaming: prepares the captured frames while
+// the stream thread sends the previous ones
+void SensorSession::process_captured_frames() {
+    placeCurrentThread(processPlacement, "aditof-process");
+
+    while (!stop_flag.load()) {
+        {
+            std::unique_lock<std::mutex> lock(frameMutex);
+            if (!cvGetFrame.wait_for(
+                    lock, std::chrono::milliseconds(500), [this]() {
+                        return !frameRing.empty() || stop_flag.load();
+                    })) {
+                continue;
+            }
+        }
+
+        if (!take_captured_frame()) {
+            continue;
+        }
+        PreparedFrame prepared;
+        if (!prepare_frame(buff_frame_to_send, prepared)) {
+            ++framesDroppedBusyClient;
+            LOG(INFO) << "Client is busy , dropping the frame!";
+            continue;
+        }
+
+        // Wait for the send stage to have room, frames meanwhile stay in the
+        // capture ring
+        {
+            std::unique_lock<std::mutex> lock(frameMutex);
+            while (preparedFrames.size() >= PIPELINE_DEPTH &&
+                   !stop_flag.load()) {
+                cvGetFrame.wait_for(lock, std::chrono::milliseconds(500));
+            }
+            if (stop_flag.load()) {
+                prepared.payload->pool->release(prepared.payload);
+                break;
+            }
+            prepared.enqueueTimestamp = wall_clock_ns();
+            preparedFrames.push_back(prepared);
+        }
+        cvGetFrame.notify_all();
+    }
+}
+
+void SensorSession::stream_zmq_frame() {
 
     // Establish the connection and stream the frames. Since zmq is not thread safe
     // It needs to be initialized and used in same thread.
 
-    static zmq::context_t zmq_context(1);
-    server_socket =
-        std::make_unique<zmq::socket_t>(zmq_context, zmq::socket_type::push);
+    placeCurrentThread(sendPlacement, "aditof-send");
+    server_socket = std::make_unique<zmq::socket_t>(stream_context(),
+                                                    zmq::socket_type::push);
     server_socket->set(zmq::sockopt::sndhwm, static_cast<int>(max_send_frames));
     server_socket->set(zmq::sockopt::sndtimeo, FRAME_TIMEOUT);
-    server_socket->bind("tcp://*:5555");
+    server_socket->bind("tcp://*:" + std::to_string(streamPort));
     LOG(INFO) << "ZMQ server socket connection established.";
 
     LOG(INFO) << "stream_frame thread running in the background.";
@@ -170,37 +1282,48 @@ void stream_zmq_frame() {
             break;
         }
 
-        // 1. Wait for frame to be captured on the other thread
-        std::unique_lock<std::mutex> lock(frameMutex);
-        if (!cvGetFrame.wait_for(lock, std::chrono::milliseconds(500), []() {
-                return frameCaptured || stop_flag.load();
-            })) {
-            LOG(WARNING) << "stream_zmq_frame: Timeout waiting for "
-                            "frameCaptured or stop_flag";
-            continue;
-        }
-
-        // 2. Get your hands on the captured frame
-        std::swap(buff_frame_to_send, buff_frame_to_be_captured);
-        frameCaptured = false;
-        lock.unlock();
-
-        // 3. Trigger the other thread to capture another frame while we do stuff with current frame
+        // 1. Wait for the process stage to have a frame ready and, in
+        // credit mode, for the client to be able to take it
+        PreparedFrame prepared;
         {
-            std::lock_guard<std::mutex> lock(frameMutex);
-            goCaptureFrame = true;
+            std::unique_lock<std::mutex> lock(frameMutex);
+            if (frameCreditsEnabled && frameCredits == 0 &&
+                !preparedFrames.empty()) {
+                ++creditStalls;
+            }
+            if (!cvGetFrame.wait_for(
+                    lock, std::chrono::milliseconds(500), [this]() {
+                        return (!preparedFrames.empty() &&
+                                (!frameCreditsEnabled || frameCredits > 0)) ||
+                               stop_flag.load();
+                    })) {
+                if (preparedFrames.empty()) {
+                    LOG(WARNING) << "stream_zmq_frame: Timeout waiting for "
+                                    "a prepared frame or stop_flag";
+                }
+                continue;
+            }
+            if (preparedFrames.empty()) {
+                continue;
+            }
+
+            // 2. Get your hands on the prepared frame. The capture and
+            // process stages keep going on their own while it is sent.
+            prepared = preparedFrames.front();
+            preparedFrames.pop_front();
         }
-        cvGetFrame.notify_one();
+        cvGetFrame.notify_all();
 
         if (!server_socket) {
             LOG(ERROR) << "ZMQ server socket is not initialized!";
+            prepared.payload->pool->release(prepared.payload);
             break;
         }
-        zmq::message_t message(buff_frame_length);
-        memcpy(message.data(), buff_frame_to_send, buff_frame_length);
-        auto send = server_socket->send(message, zmq::send_flags::none);
-        if (!send.has_value()) {
+        if (!transmit_frame(prepared)) {
+            ++framesDroppedBusyClient;
             LOG(INFO) << "Client is busy , dropping the frame!";
+        } else if (frameCreditsEnabled) {
+            --frameCredits;
         }
     }
 
@@ -214,7 +1337,7 @@ void stream_zmq_frame() {
     LOG(INFO) << "stream_zmq_frame thread stopped successfully.";
 }
 
-void start_stream_thread() {
+void SensorSession::start_stream_thread() {
 
     // Reset the stop flag
     stop_flag.store(false);
@@ -225,11 +1348,20 @@ void start_stream_thread() {
         stream_thread.join(); // Ensure the previous thread is cleaned up
     }
 
-    stream_thread = std::thread(stream_zmq_frame); // Assign thread
+    if (processThread.joinable()) {
+        processThread.join();
+    }
+
+    stream_thread =
+        std::thread(&SensorSession::stream_zmq_frame, this); // Assign thread
+    processThread =
+        std::thread(&SensorSession::process_captured_frames, this);
 }
 
-void stop_stream_thread() {
-    if (!running) {
+void SensorSession::stop_stream_thread() {
+    captureFreeRunning = false;
+
+    if (!running && !processThread.joinable()) {
         return; // If thread is already stopped exit the function.
     }
 
@@ -242,7 +1374,7 @@ void stop_stream_thread() {
     {
         std::unique_lock<std::mutex> lock(mtx);
         while (!cv.wait_for(lock, std::chrono::milliseconds(500),
-                            [] { return running.load() == false; })) {
+                            [this] { return running.load() == false; })) {
             // Wait until the thread has stopped
             LOG(INFO) << "Waiting for stream thread to stop...";
         }
@@ -256,120 +1388,432 @@ void stop_stream_thread() {
     if (stream_thread.joinable()) {
         stream_thread.join(); // Ensure the thread exits cleanly.
     }
+    if (processThread.joinable()) {
+        processThread.join();
+    }
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        for (PreparedFrame &prepared : preparedFrames) {
+            prepared.payload->pool->release(prepared.payload);
+        }
+        preparedFrames.clear();
+    }
 
-    LOG(INFO) << "stream thread stopped.";
+    LOG(INFO) << "stream thread stopped. Zero-copy frames sent: "
+              << framePool.zeroCopyFrames() << " ("
+              << framePool.zeroCopyBytes() / (1024 * 1024)
+              << " MB not copied), frame pool exhausted "
+              << framePool.exhaustedCount() << " times.";
+    LOG(INFO) << "Frame capture: wait p50/p99/max "
+              << frameWaitDuration.percentileUs(50) << "/"
+              << frameWaitDuration.percentileUs(99) << "/"
+              << frameWaitDuration.maxUs() << " us, getFrame p50/p99/max "
+              << getFrameDuration.percentileUs(50) << "/"
+              << getFrameDuration.percentileUs(99) << "/"
+              << getFrameDuration.maxUs() << " us, " << captureTimeouts.load()
+              << " timeouts, " << captureStalls.load() << " stalls.";
+    LOG(INFO) << "Frames dropped: " << frameRing.droppedOldest()
+              << " oldest and " << frameRing.droppedNewest()
+              << " newest with the capture ring full, "
+              << framesDroppedNoBuffer.load() << " without a free buffer.";
 }
 
-aditof::SensorInterruptCallback callback = [](aditof::Adsd3500Status status) {
-    {
-        if (adsd3500InterruptsQueueMutex.try_lock_for(
-                std::chrono::milliseconds(500))) {
-            adsd3500InterruptsQueue.push(status);
-            adsd3500InterruptsQueueMutex.unlock();
-        } else {
-            LOG(ERROR)
-                << "Unable to lock adsd3500InterruptsQueueMutex for 500 ms";
-        }
+// Waits until the V4L2 device has a filled buffer or timeout expires. Sensors
+// that don't expose their device are treated as always ready and left to the
+// watchdog.
+bool SensorSession::wait_for_sensor_frame(std::chrono::milliseconds timeout) {
+    int fd = -1;
+    if (!sensorV4lBufAccess ||
+        sensorV4lBufAccess->getDeviceFileDescriptor(fd) !=
+            aditof::Status::OK ||
+        fd < 0) {
+        return true;
     }
-    DLOG(INFO) << "ADSD3500 interrupt occured: status = " << status;
-};
 
-// Function executed in the capturing frame thread
-static void captureFrameFromHardware() {
+    struct pollfd pfd = {fd, POLLIN, 0};
+    auto start = std::chrono::steady_clock::now();
+    int rc;
+    do {
+        rc = poll(&pfd, 1, static_cast<int>(timeout.count()));
+    } while (rc == -1 && errno == EINTR);
+    frameWaitDuration.record(std::chrono::steady_clock::now() - start);
+
+    // On errors let getFrame() run and report what went wrong
+    return rc != 0;
+}
+
+// Function executed in the capture watchdog thread. getFrame() can't be
+// interrupted, but a call that hangs (e.g. in depth compute) gets reported
+// instead of silently stopping the stream.
+void SensorSession::superviseFrameCapture() {
+    int64_t reportedStartNs = 0;
+    std::mutex watchdogMutex;
+    std::unique_lock<std::mutex> lock(watchdogMutex);
+
     while (keepCaptureThreadAlive) {
+        cvCaptureWatchdog.wait_for(lock, std::chrono::milliseconds(100));
 
-        // 1. Wait for the signal to start capturing a new frame
-        std::unique_lock<std::mutex> lock(frameMutex);
-        if (!cvGetFrame.wait_for(lock, std::chrono::milliseconds(500), [] {
-                return goCaptureFrame || !keepCaptureThreadAlive;
-            })) {
-            // If the wait times out, check if we should keep the thread alive
+        int64_t startNs = getFrameStartNs.load();
+        if (startNs == 0 || startNs == reportedStartNs) {
             continue;
         }
 
-        if (!keepCaptureThreadAlive) {
-            break;
+        auto elapsed = std::chrono::steady_clock::now().time_since_epoch() -
+                       std::chrono::nanoseconds(startNs);
+        if (elapsed > get_frame_timeout) {
+            ++captureStalls;
+            reportedStartNs = startNs;
+            LOG(ERROR) << "getFrame() has been blocked for "
+                       << std::chrono::duration_cast<std::chrono::milliseconds>(
+                              elapsed)
+                              .count()
+                       << " ms";
         }
+    }
+}
 
-        // 2. The signal has been received, now go capture the frame
-        goCaptureFrame = false;
+// Function executed in the capturing frame thread
+void SensorSession::captureFrameFromHardware() {
+    std::vector<uint8_t> discardBuffer;
+    placeCurrentThread(capturePlacement, "aditof-capture");
 
-        // Send frames to PC via ZMQ socket.
-        auto getFramefuture = std::async(std::launch::async, [&]() {
-            // Get a new frame from the sensor
-            return camDepthSensor->getFrame(
-                (uint16_t *)buff_frame_to_be_captured);
-        });
+    while (keepCaptureThreadAlive) {
 
-        if (getFramefuture.wait_for(get_frame_timeout) ==
-            std::future_status::timeout) {
-            LOG(ERROR) << "Timeout while waiting for frame from sensor.";
-            continue;
-        } else {
-            aditof::Status status = getFramefuture.get();
-            if (status != aditof::Status::OK) {
-                LOG(ERROR) << "Failed to get frame from sensor: " << status;
+        // 1. Wait for the signal to start capturing a new frame. While
+        // streaming asynchronously there is no signal, frames are captured
+        // back to back.
+        {
+            std::unique_lock<std::mutex> lock(frameMutex);
+            if (!cvGetFrame.wait_for(
+                    lock, std::chrono::milliseconds(500), [this] {
+                        return goCaptureFrame || captureFreeRunning.load() ||
+                               !keepCaptureThreadAlive;
+                    })) {
+                // If the wait times out, check if we should keep the thread alive
                 continue;
             }
+
+            if (!keepCaptureThreadAlive) {
+                break;
+            }
+
+            goCaptureFrame = false;
         }
 
-        // 3. Notify others that there is a new frame available
-        frameCaptured = true;
-        lock.unlock();
-        cvGetFrame.notify_one();
-    }
+        // 2. Get a buffer to capture into without waiting for the network to
+        // give one back. If all of them are in use the frame is still read so
+        // the V4L2 queue keeps moving, but it is dropped.
+        FramePool::Buffer *buffer =
+            framePool.acquire(std::chrono::milliseconds(0));
+        uint8_t *target = nullptr;
+        if (buffer) {
+            target = buffer->data;
+        } else {
+            discardBuffer.resize(buff_frame_length);
+            target = discardBuffer.data();
+        }
 
-    return;
-}
+        // 3. Wait until the driver has a frame, so that getFrame() does not
+        // block past the deadline, then get the frame on this thread.
+        bool captured = false;
+        if (wait_for_sensor_frame(get_frame_timeout)) {
+            std::unique_lock<std::mutex> sensor = lock_sensor();
+            auto start = std::chrono::steady_clock::now();
+            getFrameStartNs =
+                std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    start.time_since_epoch())
+                    .count();
 
-static void cleanup_sensors() {
-    // Stop the frame capturing thread
-    if (frameCaptureThread.joinable()) {
-        keepCaptureThreadAlive = false;
-        { std::lock_guard<std::mutex> lock(frameMutex); }
-        cvGetFrame.notify_one();
-        frameCaptureThread.join();
-    }
+            aditof::Status status = frameSource->getFrame((uint16_t *)target);
 
-    camDepthSensor->adsd3500_unregister_interrupt_callback(callback);
-    sensorV4lBufAccess.reset();
-    camDepthSensor.reset();
+            getFrameStartNs = 0;
+            getFrameDuration.record(std::chrono::steady_clock::now() - start);
 
-    {
-        if (adsd3500InterruptsQueueMutex.try_lock_for(
-                std::chrono::milliseconds(500))) {
-            while (!adsd3500InterruptsQueue.empty()) {
-                adsd3500InterruptsQueue.pop();
+            if (status != aditof::Status::OK) {
+                ++captureFailures;
+                LOG(ERROR) << "Failed to get frame from sensor: " << status;
+            } else {
+                ++framesCaptured;
+                captured = true;
             }
-            adsd3500InterruptsQueueMutex.unlock();
         } else {
-            LOG(ERROR)
-                << "Unable to lock adsd3500InterruptsQueueMutex in 500 ms";
+            ++captureTimeouts;
+            LOG(ERROR) << "Timeout while waiting for frame from sensor.";
         }
-    }
 
-    sensors_are_created = false;
+        if (!captured) {
+            if (buffer) {
+                framePool.release(buffer);
+            }
+            report_capture_failure();
+            continue;
+        }
+
+        uint64_t read = captureCounter++;
+        if (!buffer) {
+            ++framesDroppedNoBuffer;
+            report_capture_failure();
+            continue;
+        }
+        buffer->captureTimestamp = wall_clock_ns();
+        buffer->captureIndex = number_captured_frame(buffer, read);
+
+        // 4. Queue the frame and notify others that there is a new frame
+        // available. Subscribers take their own reference first.
+        frameFanout.offer(buffer);
+        FramePool::Buffer *dropped = frameRing.push(buffer);
+        if (dropped) {
+            framePool.release(dropped);
+        }
+        size_t occupancy = frameRing.size();
+        if (occupancy > frameRingPeak) {
+            frameRingPeak = occupancy;
+        }
+        { std::lock_guard<std::mutex> lock(frameMutex); }
+        cvGetFrame.notify_all();
+    }
+
+    return;
+}
+
+// Tells a GetFrame waiting for the frame that it won't come. Streaming
+// asynchronously nobody waits, the next frame is captured right away.
+void SensorSession::report_capture_failure() {
+    if (captureFreeRunning) {
+        return;
+    }
+    {
+        std::lock_guard<std::mutex> lock(frameMutex);
+        captureFailed = true;
+    }
+    cvGetFrame.notify_all();
+}
+
+// Maps the frame buffers once for the largest mode of the sensor, so that
+// switching modes reuses them
+void SensorSession::reserve_frame_buffers() {
+    std::vector<uint8_t> modes;
+    if (frameSource->getAvailableModes(modes) != aditof::Status::OK) {
+        return;
+    }
+
+    size_t largest = 0;
+    for (uint8_t mode : modes) {
+        aditof::DepthSensorModeDetails details;
+        if (frameSource->getModeDetails(mode, details) != aditof::Status::OK) {
+            continue;
+        }
+        // As computed when the mode is set, 4 planes at most outside PCM
+        size_t pixels = static_cast<size_t>(details.baseResolutionWidth) *
+                        details.baseResolutionHeight;
+        size_t planes = details.isPCM ? details.numberOfPhases : 4;
+        largest = std::max(largest, pixels * planes * sizeof(uint16_t));
+    }
+    if (largest == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(frameMutex);
+    if (framePool.reserve(largest, frame_pool_size()) != aditof::Status::OK) {
+        LOG(WARNING) << "Unable to reserve frame buffers of " << largest
+                     << " bytes, they are allocated at each mode change";
+    }
+}
+
+// Fills currentFrame for a mode whose processedFrameSize was just computed
+void SensorSession::describe_frame(
+    const aditof::DepthSensorModeDetails &details) {
+    const int pixels =
+        details.baseResolutionWidth * details.baseResolutionHeight;
+
+    currentFrame.modeNumber = details.modeNumber;
+    currentFrame.width = static_cast<uint16_t>(details.baseResolutionWidth);
+    currentFrame.height = static_cast<uint16_t>(details.baseResolutionHeight);
+    if (details.isPCM) {
+        currentFrame.layout = FRAME_LAYOUT_PCM;
+        currentFrame.planeCount = static_cast<uint16_t>(details.numberOfPhases);
+    } else if (pixels > 0 && processedFrameSize == pixels * 2) {
+        currentFrame.layout = FRAME_LAYOUT_DEPTH_AB;
+        currentFrame.planeCount = 2;
+    } else {
+        currentFrame.layout = FRAME_LAYOUT_DEPTH_AB_CONF;
+        currentFrame.planeCount = 3;
+    }
+}
+
+// (Re)creates the frame pool for a new mode and takes the buffer that the
+// send side starts with.
+aditof::Status SensorSession::allocate_frame_buffers(size_t frameSize) {
+    std::lock_guard<std::mutex> lock(frameMutex);
+
+    drain_frame_ring();
+    if (buff_frame_to_send != nullptr) {
+        framePool.release(buff_frame_to_send);
+        buff_frame_to_send = nullptr;
+    }
+
+    aditof::Status status = framePool.allocate(frameSize, frame_pool_size());
+    if (status != aditof::Status::OK) {
+        return status;
+    }
+
+    buff_frame_to_send = framePool.acquire(std::chrono::milliseconds(0));
+    buff_frame_length = frameSize;
+
+    FanoutStream stream;
+    stream.generation = framePool.generation();
+    stream.modeNumber = currentFrame.modeNumber;
+    stream.layout = currentFrame.layout;
+    stream.width = currentFrame.width;
+    stream.height = currentFrame.height;
+    stream.planeCount = currentFrame.planeCount;
+    stream.frameSize = frameSize;
+    frameFanout.setStream(stream);
+
+    return aditof::Status::OK;
+}
+
+void SensorSession::cleanup_sensors() {
+    // Stop the frame capturing thread
+    if (frameCaptureThread.joinable()) {
+        keepCaptureThreadAlive = false;
+        { std::lock_guard<std::mutex> lock(frameMutex); }
+        cvGetFrame.notify_all();
+        frameCaptureThread.join();
+    }
+    if (captureWatchdogThread.joinable()) {
+        cvCaptureWatchdog.notify_all();
+        captureWatchdogThread.join();
+    }
+
+    if (camDepthSensor) {
+        camDepthSensor->adsd3500_unregister_interrupt_callback(callback);
+    }
+    sensorV4lBufAccess.reset();
+    camDepthSensor.reset();
+    frameSource.reset();
+
+    // What the sensor reported is still published, but no longer kept for
+    // GetInterrupts
+    {
+        std::lock_guard<std::mutex> lock(interruptMutex);
+        pendingInterrupts.clear();
+    }
+
+    warm = false;
+    activeMode = -1;
+    depthComputeIni.clear();
+    depthComputeCal.clear();
+    reset_client_settings();
+}
+
+// Forgets what the client asked for, the sensor being left as it is
+void SensorSession::reset_client_settings() {
     clientEngagedWithSensors = false;
+    rebound = false;
+    firstFramePending = false;
+    frameHeaderEnabled = false;
+    send_async = false;
+    compressFrames = false;
+    tileDeltaFrames = false;
+    shmTransport = false;
+    shmRing.destroy();
+    packFrames = false;
+    frameContentMask = 0;
+    frameRegion = FrameRegion();
+    regionEnabled = false;
+    frameCreditsEnabled = false;
+    frameCredits = 0;
 }
 
-void server_event(std::unique_ptr<zmq::socket_t> &monitor) {
-    while (!interrupted) {
-        zmq::pollitem_t items[] = {
-            {static_cast<void *>(monitor->handle()), 0, ZMQ_POLLIN, 0}};
+// Keeps the sensor open for the next client, the capture thread idling
+// until then
+void SensorSession::park() {
+    reset_client_settings();
+    warm = true;
+    warmSince = std::chrono::steady_clock::now();
+    LOG(INFO) << "Keeping sensor " << index << " open for "
+              << warmGrace.count() << " ms";
+}
 
-        int rc;
-        do {
-            rc = zmq_poll(items, 1, 1000);
-        } while (rc == -1 && zmq_errno() == EINTR);
+// Hands a warm session to the client now using it
+void SensorSession::rebind() {
+    warm = false;
+    rebound = true;
+    clientEngagedWithSensors = true;
+    ++warmRebinds;
+    LOG(INFO) << "Sensor " << index << " picked up warm";
+}
+
+// Sensors are searched again at the next FindSensors once no session uses
+// them any more
+static void release_sensors_if_unused() {
+    for (const auto &session : sessions) {
+        if (session->frameSource) {
+            return;
+        }
+    }
+    sensors_are_created = false;
+}
+
+// Ends what the client was doing with every sensor
+static void end_client_sessions() {
+    for (auto &session : sessions) {
+        session->cancel_jobs();
+        session->stop_stream_thread();
+        if (session->isConnectionClosed == false) {
+            std::unique_lock<std::mutex> sensor = session->lock_sensor();
+            session->close_zmq_connection();
+        }
+        if (session->clientEngagedWithSensors && warmGrace.count() > 0 &&
+            session->frameSource) {
+            session->park();
+        } else if (session->clientEngagedWithSensors) {
+            session->cleanup_sensors();
+        }
+    }
+    release_sensors_if_unused();
+}
 
-        if (items[0].revents & ZMQ_POLLIN) {
-            zmq_event_t event;
-            zmq::message_t msg;
-            monitor->recv(msg);
-            memcpy(&event, msg.data(), sizeof(event));
-            Network::callback_function(event);
+// Closes the sensors of the warm sessions no client picked up in time
+static void expire_warm_sessions() {
+    const auto now = std::chrono::steady_clock::now();
+    bool expired = false;
+    for (auto &session : sessions) {
+        if (session->warm && now - session->warmSince >= warmGrace) {
+            LOG(INFO) << "Closing sensor " << session->index
+                      << ", no client picked it up";
+            ++session->warmExpired;
+            session->cleanup_sensors();
+            expired = true;
         }
     }
+    if (expired) {
+        release_sensors_if_unused();
+    }
+}
+
+// Reads one event from the monitor of the command socket. An event is a
+// 6-byte frame (16-bit event id, 32-bit value) followed by the peer address.
+static bool read_monitor_event(zmq::socket_t &monitor) {
+    zmq::message_t msg;
+    if (!monitor.recv(msg, zmq::recv_flags::dontwait)) {
+        return false;
+    }
+
+    zmq_event_t event = {};
+    if (msg.size() >= sizeof(uint16_t) + sizeof(uint32_t)) {
+        const uint8_t *data = static_cast<const uint8_t *>(msg.data());
+        memcpy(&event.event, data, sizeof(uint16_t));
+        memcpy(&event.value, data + sizeof(uint16_t), sizeof(uint32_t));
+    }
+
+    while (msg.more()) {
+        monitor.recv(msg);
+    }
+
+    Network::callback_function(event);
+    return true;
 }
 
 int Network::callback_function(const zmq_event_t &event) {
@@ -380,63 +1824,34 @@ int Network::callback_function(const zmq_event_t &event) {
     }
     case ZMQ_EVENT_CLOSED:
         std::cout << "Closed connection " << std::endl;
-        if (Client_Connected && !no_of_client_connected) {
+        // fall through
+    case ZMQ_EVENT_DISCONNECTED: {
+        if (Client_Connected &&
+            static_cast<int>(event.value) == clientSocketFd) {
             std::cout << "Connection Closed" << std::endl;
-            stop_stream_thread();
-            if (isConnectionClosed == false) {
-                close_zmq_connection();
-            }
-            if (clientEngagedWithSensors) {
-                cleanup_sensors();
-                clientEngagedWithSensors = false;
-            }
+            end_client_sessions();
             Client_Connected = false;
-        } else {
+            clientSocketFd = -1;
+        } else if (no_of_client_connected > 0) {
             std::cout << "Another Client Connection Closed" << std::endl;
-            no_of_client_connected = false;
+            --no_of_client_connected;
         }
         break;
+    }
     case ZMQ_EVENT_CONNECT_RETRIED:
         std::cout << "Connection retried to " << std::endl;
         break;
     case ZMQ_EVENT_ACCEPTED:
-        buff_send.Clear();
         if (!Client_Connected) {
             std::cout << "Conn Established" << std::endl;
-            {
-                if (connection_mtx.try_lock_for(
-                        std::chrono::milliseconds(200))) {
-                    Client_Connected = true;
-                    connection_mtx.unlock();
-                } else {
-                    LOG(ERROR) << "Unable to lock the connection_mtx";
-                    break; // Not able to lock the mutex in 100 ms
-                }
-            }
-            buff_send.set_message("Connection Allowed");
+            Client_Connected = true;
+            clientSocketFd = static_cast<int>(event.value);
+            clientConnectedAt = std::chrono::steady_clock::now();
         } else {
             std::cout << "Another client connected" << std::endl;
-            no_of_client_connected = true;
-        }
-        break;
-    case ZMQ_EVENT_DISCONNECTED: {
-        if (Client_Connected && !no_of_client_connected) {
-            std::cout << "Connection Closed" << std::endl;
-            stop_stream_thread();
-            if (isConnectionClosed == false) {
-                close_zmq_connection();
-            }
-            if (clientEngagedWithSensors) {
-                cleanup_sensors();
-                clientEngagedWithSensors = false;
-            }
-            Client_Connected = false;
-        } else {
-            std::cout << "Another Client Connection Closed" << std::endl;
-            no_of_client_connected = false;
+            ++no_of_client_connected;
         }
         break;
-    }
     default:
 #ifdef NW_DEBUG
         std::cout << "Event: " << event.event << " on " << addr << std::endl;
@@ -446,43 +1861,137 @@ int Network::callback_function(const zmq_event_t &event) {
     return 0;
 }
 
-void data_transaction() {
+// Requests the clients other than the controlling one may send
+static bool allowed_to_other_clients(api_Values api) {
+    switch (api) {
+    case SERVER_CONNECT:
+    case GET_SERVER_STATS:
+    case SUBSCRIBE:
+    case UNSUBSCRIBE:
+        return true;
+    default:
+        return false;
+    }
+}
 
-    while (!interrupted) {
+// Receives one request from the command socket, runs it and sends the reply
+static void process_request() {
+    zmq::message_t request;
+    if (!server_cmd->recv(request, zmq::recv_flags::dontwait)) {
+        return;
+    }
 
-        zmq::message_t request;
+    static google::protobuf::Arena arena([] {
+        google::protobuf::ArenaOptions options;
+        options.initial_block = rpcArenaBlock;
+        options.initial_block_size = sizeof(rpcArenaBlock);
+        return options;
+    }());
+
+    auto *clientRequest =
+        google::protobuf::Arena::CreateMessage<payload::ClientRequest>(&arena);
+    auto *serverResponse =
+        google::protobuf::Arena::CreateMessage<payload::ServerResponse>(
+            &arena);
+
+    // Parsing copies the bytes payloads into the arena. A request that can't
+    // be parsed is answered without running any part of it.
+    auto rpcStart = std::chrono::steady_clock::now();
+    api_Values apiValue = API_NOT_DEFINED;
+    if (clientRequest->ParseFromArray(request.data(),
+                                      static_cast<int>(request.size()))) {
+        auto api = s_map_api_Values.find(clientRequest->func_name());
+        if (api != s_map_api_Values.end()) {
+            apiValue = api->second;
+        }
+        // The client whose connection was accepted first drives the
+        // sensors, the other peers of the socket can only watch the stream
+        if ((Client_Connected && request.get(ZMQ_SRCFD) == clientSocketFd) ||
+            allowed_to_other_clients(apiValue)) {
+            invoke_sdk_api(*clientRequest, *serverResponse);
+        } else {
+            ++otherClientRejects;
+            serverResponse->set_message(
+                "Only the controlling client can call " +
+                clientRequest->func_name() +
+                ", other clients can Subscribe, Unsubscribe and "
+                "GetServerStats");
+            serverResponse->set_status(
+                static_cast<::payload::Status>(aditof::Status::BUSY));
+        }
+    } else {
+        LOG(WARNING) << "Failed to parse client request";
+        serverResponse->set_server_status(
+            ::payload::ServerStatus::REQUEST_UNKNOWN);
+        serverResponse->set_message("Malformed request");
+        serverResponse->set_status(
+            static_cast<::payload::Status>(aditof::Status::INVALID_ARGUMENT));
+    }
 
-        if (connection_mtx.try_lock_for(std::chrono::milliseconds(200))) {
+    // Serialize the reply directly into the message handed to ZMQ
+    zmq::message_t reply(serverResponse->ByteSizeLong());
+    serverResponse->SerializeWithCachedSizesToArray(
+        static_cast<uint8_t *>(reply.data()));
+    if (server_cmd->send(reply, zmq::send_flags::none)) {
+#ifdef NW_DEBUG
+        LOG(INFO) << "Data is sent ";
+#endif
+    }
 
-            if (Client_Connected) {
-                if (server_cmd->recv(request, zmq::recv_flags::dontwait)) {
-                    google::protobuf::io::ArrayInputStream ais(request.data(),
-                                                               request.size());
-                    google::protobuf::io::CodedInputStream coded_input(&ais);
-                    buff_recv.ParseFromCodedStream(&coded_input);
-                    invoke_sdk_api(buff_recv);
+    arena.Reset();
 
-                    // Preparing to send the data
-                    unsigned int siz = buff_send.ByteSize();
-                    unsigned char *pkt = new unsigned char[siz];
+    rpcDuration[apiValue].record(std::chrono::steady_clock::now() - rpcStart);
+}
 
-                    google::protobuf::io::ArrayOutputStream aos(pkt, siz);
-                    google::protobuf::io::CodedOutputStream coded_output(&aos);
-                    buff_send.SerializeToCodedStream(&coded_output);
+// Command plane event loop. Sleeps in zmq_poll() until either a connection
+// event or a request arrives. Requests are read whether or not there is a
+// controlling client, so that subscribers can still leave once it is gone.
+void data_transaction() {
+    while (!interrupted) {
+        zmq::pollitem_t items[] = {
+            {static_cast<void *>(monitor_socket->handle()), 0, ZMQ_POLLIN, 0},
+            {static_cast<void *>(server_cmd->handle()), 0, ZMQ_POLLIN, 0}};
 
-                    // Create a zmq message
-                    zmq::message_t reply(pkt, siz);
-                    if (server_cmd->send(reply, zmq::send_flags::none)) {
-#ifdef NW_DEBUG
-                        LOG(INFO) << "Data is sent ";
-#endif
-                    }
-                    delete[] pkt;
-                }
+        int rc;
+        do {
+            rc = zmq_poll(items, 2, 1000);
+        } while (rc == -1 && zmq_errno() == EINTR && !interrupted);
+
+        expire_warm_sessions();
+        if (rc <= 0) {
+            continue;
+        }
+
+        // A connection is accepted before any of its requests arrive, so
+        // reading every pending event first tells which client sent them
+        while (read_monitor_event(*monitor_socket)) {
+        }
+
+        if (items[1].revents & ZMQ_POLLIN) {
+            process_request();
+        }
+    }
+}
+
+// Interrupt publisher thread. Sleeps until a sensor callback queues an
+// interrupt and publishes it at once, whatever request the command thread
+// is serving. It alone uses interrupt_pub.
+static void run_interrupt_publisher() {
+    while (interruptPublisherRunning) {
+        struct pollfd pfd = {interruptEventFd, POLLIN, 0};
+        if (interruptEventFd >= 0) {
+            if (poll(&pfd, 1, 500) > 0) {
+                uint64_t count;
+                ssize_t got = read(interruptEventFd, &count, sizeof(count));
+                (void)got;
             }
-            connection_mtx.unlock();
         } else {
-            continue; // not able to lock connection mutex in 200 ms try again
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        for (auto &session : sessions) {
+            session->publish_interrupts();
         }
     }
 }
@@ -493,6 +2002,158 @@ int main(int argc, char *argv[]) {
     signal(SIGINT, sigint_handler);
     signal(SIGTERM, sigint_handler);
 
+    std::map<std::string, struct Argument> command_map = {
+        {"-h", {"--help", false, "", "", false}},
+        {"-rd", {"--ring-depth", false, "", "4", true}},
+        {"-dp", {"--drop-policy", false, "", "oldest", true}},
+        {"-cw", {"--compress-workers", false, "", "2", true}},
+        {"-shm", {"--shm-name", false, "", "/aditof-frames", true}},
+        {"-fo", {"--fan-out", false, "", "0", true}},
+        {"-cc", {"--capture-cpu", false, "", "", true}},
+        {"-pc", {"--process-cpu", false, "", "", true}},
+        {"-sc", {"--send-cpu", false, "", "", true}},
+        {"-wg", {"--warm-grace", false, "", "30", true}},
+        {"-ir", {"--interrupt-port", false, "", "5557", true}},
+        {"-sy", {"--synthetic", false, "", "", false}},
+        {"-rp", {"--replay", false, "", "", true}},
+        {"-fps", {"--fps", false, "", "30", true}},
+        {"-rs", {"--replay-size", false, "", "", true}}};
+
+    CommandParser command;
+    std::string arg_error;
+
+    command.parseArguments(argc, argv, command_map);
+    int result = command.checkArgumentExist(command_map, arg_error);
+    if (result != 0) {
+        LOG(ERROR) << "Argument " << arg_error << " doesn't exist!";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    result = command.helpMenu();
+    if (result == 1) {
+        std::cout << Help_Menu;
+        return 0;
+    } else if (result == -1) {
+        LOG(ERROR) << "Usage of argument -h/--help"
+                   << " is incorrect! Help argument should be used alone!";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    result = command.checkValue(command_map, arg_error);
+    if (result != 0) {
+        LOG(ERROR) << "Argument: " << command_map[arg_error].long_option
+                   << " doesn't have assigned or default value!";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    int ringDepth = std::atoi(command_map["-rd"].value.c_str());
+    if (ringDepth < 1) {
+        LOG(ERROR) << "Ring depth must be at least 1";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    if (command_map["-dp"].value == "oldest") {
+        frameRingPolicy = DropPolicy::DROP_OLDEST;
+    } else if (command_map["-dp"].value == "newest") {
+        frameRingPolicy = DropPolicy::DROP_NEWEST;
+    } else {
+        LOG(ERROR) << "Unknown drop policy: " << command_map["-dp"].value;
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    frameRingDepth = static_cast<size_t>(ringDepth);
+
+    int compressWorkersArg = std::atoi(command_map["-cw"].value.c_str());
+    if (compressWorkersArg < 0) {
+        LOG(ERROR) << "Compress workers can't be negative";
+        std::cout << Help_Menu;
+        return -1;
+    }
+    compressWorkerCount = static_cast<size_t>(compressWorkersArg);
+
+    shmBaseName = command_map["-shm"].value;
+    if (shmBaseName.size() < 2 || shmBaseName[0] != '/' ||
+        shmBaseName.find('/', 1) != std::string::npos) {
+        LOG(ERROR) << "Shared memory name must be /<name>";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    int fanOut = std::atoi(command_map["-fo"].value.c_str());
+    if (fanOut < 0 || fanOut > 16) {
+        LOG(ERROR) << "Fan-out must be between 0 and 16 subscribers";
+        std::cout << Help_Menu;
+        return -1;
+    }
+    maxSubscribers = static_cast<size_t>(fanOut);
+
+    if (!parseThreadPlacement(command_map["-cc"].value, capturePlacement) ||
+        !parseThreadPlacement(command_map["-pc"].value, processPlacement) ||
+        !parseThreadPlacement(command_map["-sc"].value, sendPlacement)) {
+        LOG(ERROR) << "Stage placement must be <cpu>[:<priority>], with a "
+                      "priority from 1 to 99";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    int warmGraceArg = std::atoi(command_map["-wg"].value.c_str());
+    if (warmGraceArg < 0) {
+        LOG(ERROR) << "Warm grace period can't be negative";
+        std::cout << Help_Menu;
+        return -1;
+    }
+    warmGrace = std::chrono::seconds(warmGraceArg);
+
+    int interruptPortArg = std::atoi(command_map["-ir"].value.c_str());
+    if (interruptPortArg < 0 || interruptPortArg > UINT16_MAX) {
+        LOG(ERROR) << "Invalid interrupt port: " << command_map["-ir"].value;
+        std::cout << Help_Menu;
+        return -1;
+    }
+    interruptPort = static_cast<uint16_t>(interruptPortArg);
+
+    replayConfig.path = command_map["-rp"].value;
+    replayEnabled =
+        !command_map["-sy"].value.empty() || !replayConfig.path.empty();
+    if (replayEnabled) {
+        int fps = std::atoi(command_map["-fps"].value.c_str());
+        if (fps < 0) {
+            LOG(ERROR) << "Frame rate can't be negative";
+            std::cout << Help_Menu;
+            return -1;
+        }
+        replayConfig.fps = static_cast<unsigned int>(fps);
+
+        const std::string &size = command_map["-rs"].value;
+        if (!size.empty() &&
+            (sscanf(size.c_str(), "%dx%d", &replayConfig.width,
+                    &replayConfig.height) != 2 ||
+             replayConfig.width <= 0 || replayConfig.height <= 0)) {
+            LOG(ERROR) << "Invalid replay size: " << size;
+            std::cout << Help_Menu;
+            return -1;
+        }
+
+        LOG(INFO) << "Streaming "
+                  << (replayConfig.path.empty() ? "a synthetic pattern"
+                                                : replayConfig.path)
+                  << " at " << replayConfig.fps << " fps instead of the "
+                  << "depth sensor";
+    }
+#ifndef TARGET
+    else {
+        LOG(ERROR) << "This build has no access to depth sensors, use "
+                      "--synthetic or --replay";
+        std::cout << Help_Menu;
+        return -1;
+    }
+#endif
+
     LOG(INFO) << "Server built \n"
               << "with SDK version: " << aditof::getApiVersion()
               << " | branch: " << aditof::getBranchVersion()
@@ -518,6 +2179,22 @@ int main(int argc, char *argv[]) {
         return 0;
     }
 
+    interruptEventFd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (interruptEventFd < 0) {
+        LOG(WARNING) << "Unable to create an eventfd, interrupts are "
+                        "published every 10 ms";
+    }
+    if (interruptPort) {
+        interrupt_pub = std::make_unique<zmq::socket_t>(*context, ZMQ_PUB);
+        interrupt_pub->set(zmq::sockopt::linger, 0);
+        try {
+            interrupt_pub->bind("tcp://*:" + std::to_string(interruptPort));
+        } catch (const zmq::error_t &e) {
+            LOG(ERROR) << "Failed to bind interrupt socket : " << e.what();
+            return 0;
+        }
+    }
+
     std::string monitor_endpoint = "inproc://monitor";
     zmq_socket_monitor(server_cmd->handle(), "inproc://monitor", ZMQ_EVENT_ALL);
 
@@ -525,31 +2202,34 @@ int main(int argc, char *argv[]) {
     // Connect the monitor socket
     monitor_socket->connect("inproc://monitor");
 
-    // run thread to receive data
-    data_transaction_thread = std::thread(data_transaction);
-    data_transaction_thread.detach();
-
     Initialize();
+    sessions.push_back(std::make_unique<SensorSession>(0));
 
-    if (sensors_are_created) {
-        cleanup_sensors();
-    }
+    interruptPublisherRunning = true;
+    std::thread interruptPublisher(run_interrupt_publisher);
 
-    while (!interrupted) {
-        server_event(monitor_socket);
-    }
+    // Serve connection events and requests until interrupted
+    data_transaction();
 
-    // Cleanup
-    if (sensors_are_created) {
-        cleanup_sensors();
+    // Cleanup. The sessions themselves go with the frame buffers ZMQ may
+    // still hold, when the process exits.
+    for (auto &session : sessions) {
+        session->stop_stream_thread();
+        {
+            std::unique_lock<std::mutex> sensor = session->lock_sensor();
+            session->close_zmq_connection();
+        }
+        session->cleanup_sensors();
+        session->frameFanout.shutdown();
     }
-    clientEngagedWithSensors = false;
 
-    if (send_async == true) {
-        stop_stream_thread();
+    interruptPublisherRunning = false;
+    if (interruptEventFd >= 0) {
+        uint64_t one = 1;
+        ssize_t written = write(interruptEventFd, &one, sizeof(one));
+        (void)written;
     }
-
-    close_zmq_connection();
+    interruptPublisher.join();
 
     if (server_cmd) {
         server_cmd->close();
@@ -559,6 +2239,14 @@ int main(int argc, char *argv[]) {
         monitor_socket->close();
         monitor_socket.reset();
     }
+    if (interrupt_pub) {
+        interrupt_pub->close();
+        interrupt_pub.reset();
+    }
+    if (interruptEventFd >= 0) {
+        close(interruptEventFd);
+        interruptEventFd = -1;
+    }
     if (context) {
         context->close();
         context.reset();
@@ -567,637 +2255,1557 @@ int main(int argc, char *argv[]) {
     return 0;
 }
 
-void invoke_sdk_api(payload::ClientRequest buff_recv) {
-    buff_send.Clear();
-    buff_send.set_server_status(::payload::ServerStatus::REQUEST_ACCEPTED);
+void SensorSession::fill_server_stats(payload::ServerStats *stats) {
+    add_stats_counter(stats, "frames_captured", framesCaptured.load());
+    add_stats_counter(stats, "frames_sent", framesSent.load());
+    add_stats_counter(stats, "bytes_sent", bytesSent.load());
+    add_stats_counter(stats, "frames_dropped_ring_oldest",
+                      frameRing.droppedOldest());
+    add_stats_counter(stats, "frames_dropped_ring_newest",
+                      frameRing.droppedNewest());
+    add_stats_counter(stats, "frames_dropped_no_buffer",
+                      framesDroppedNoBuffer.load());
+    add_stats_counter(stats, "frames_dropped_client_busy",
+                      framesDroppedBusyClient.load());
+    add_stats_counter(stats, "frames_compressed", framesCompressed.load());
+    add_stats_counter(stats, "frames_packed", framesPacked.load());
+    add_stats_counter(stats, "tiles_sent", tilesSent.load());
+    add_stats_counter(stats, "tiles_total", tilesTotal.load());
+    add_stats_counter(stats, "keyframes_sent", keyframesSent.load());
+    add_stats_counter(stats, "compress_bytes_in", compressBytesIn.load());
+    add_stats_counter(stats, "compress_bytes_out", compressBytesOut.load());
+    if (compressBytesOut > 0) {
+        add_stats_counter(stats, "compression_ratio_x1000",
+                          compressBytesIn * 1000 / compressBytesOut);
+    }
+    add_stats_counter(stats, "frame_credits", frameCredits.load());
+    add_stats_counter(stats, "frame_credit_stalls", creditStalls.load());
+    add_stats_counter(stats, "warm_rebinds", warmRebinds.load());
+    add_stats_counter(stats, "warm_expired", warmExpired.load());
+    add_stats_counter(stats, "capabilities_built", capabilitiesBuilt.load());
+    add_stats_counter(stats, "capabilities_cached", capabilitiesCached.load());
+    add_stats_counter(stats, "adsd3500_batches", adsd3500Batches.load());
+    add_stats_counter(stats, "adsd3500_batch_ops", adsd3500BatchOps.load());
+    add_stats_counter(stats, "jobs_run", jobsRun.load());
+    add_stats_counter(stats, "jobs_pending", jobs.pending());
+    add_stats_counter(stats, "interrupts", interruptsPublished.load());
+    add_stats_counter(stats, "interrupts_dropped", interruptsDropped.load());
+    add_stats_counter(stats, "capture_timeouts", captureTimeouts.load());
+    add_stats_counter(stats, "capture_failures", captureFailures.load());
+    add_stats_counter(stats, "capture_stalls", captureStalls.load());
+    add_stats_counter(stats, "get_frame_failures", getFrameFailures.load());
+    add_stats_counter(stats, "frame_ring_depth", frameRing.capacity());
+    add_stats_counter(stats, "frame_ring_occupancy", frameRing.size());
+    add_stats_counter(stats, "frame_ring_occupancy_peak", frameRingPeak.load());
+    add_stats_counter(stats, "zero_copy_frames", framePool.zeroCopyFrames());
+    add_stats_counter(stats, "zero_copy_bytes", framePool.zeroCopyBytes());
+    add_stats_counter(stats, "frame_pool_reuses", framePool.reuseCount());
+    add_stats_counter(stats, "frame_pool_hugepage_buffers",
+                      framePool.hugePageBuffers());
+    add_stats_counter(stats, "frame_pool_exhausted",
+                      framePool.exhaustedCount());
+    add_stats_counter(stats, "subscribers", frameFanout.subscriberCount());
+    for (const SubscriberStats &subscriber : frameFanout.stats()) {
+        const std::string name =
+            "subscriber_" + std::to_string(subscriber.id) + "_";
+        add_stats_counter(stats, name + "frames_sent", subscriber.framesSent);
+        add_stats_counter(stats, name + "bytes_sent", subscriber.bytesSent);
+        add_stats_counter(stats, name + "frames_dropped",
+                          subscriber.framesDropped);
+    }
 
-    DLOG(INFO) << buff_recv.func_name() << " function";
+    add_stats_histogram(stats, "frame_wait", frameWaitDuration);
+    add_stats_histogram(stats, "get_frame", getFrameDuration);
+    add_stats_histogram(stats, "process", processDuration);
+    add_stats_histogram(stats, "first_frame_cold", coldFirstFrameDuration);
+    add_stats_histogram(stats, "first_frame_warm", warmFirstFrameDuration);
+    add_stats_histogram(stats, "send", sendDuration);
+    add_stats_histogram(stats, "compress", compressDuration);
+    add_stats_histogram(stats, "pack", packDuration);
+    add_stats_histogram(stats, "tile_delta", tileDeltaDuration);
+    add_stats_histogram(stats, "transform", transformDuration);
+    add_stats_histogram(stats, "job_queued", jobQueuedDuration);
+    add_stats_histogram(stats, "job", jobDuration);
+}
 
-    auto it = s_map_api_Values.find(buff_recv.func_name());
+// Server-wide figures and those of the session a request is for
+static void fill_server_stats(SensorSession &session,
+                              payload::ServerStats *stats) {
+    stats->set_uptime_ms(
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now() - serverStartTime)
+            .count());
+    add_stats_counter(stats, "sensors", sessions.size());
+    add_stats_counter(stats, "other_client_rejects", otherClientRejects);
+
+    session.fill_server_stats(stats);
+    for (const auto &api : s_map_api_Values) {
+        if (rpcDuration[api.second].count() > 0) {
+            add_stats_histogram(stats, "rpc_" + api.first,
+                                rpcDuration[api.second]);
+        }
+    }
+}
 
-    if (it != s_map_api_Values.end()) {
-
-        switch (s_map_api_Values[buff_recv.func_name()]) {
-
-        case FIND_SENSORS: {
-            if (!sensors_are_created) {
-                sensorsEnumerator = aditof::SensorEnumeratorFactory::
-                    buildTargetSensorEnumerator();
-                if (!sensorsEnumerator) {
-                    std::string errMsg =
-                        "Failed to create a target sensor enumerator";
-                    LOG(WARNING) << errMsg;
-                    buff_send.set_message(errMsg);
-                    buff_send.set_status(static_cast<::payload::Status>(
-                        aditof::Status::UNAVAILABLE));
-                    break;
-                }
+// Checks that what a request works on exists: the frame source once sensors
+// have been found and, for controls, registers and depth compute, the depth
+// sensor itself, which a replay doesn't have. Otherwise fills in the reply.
+bool SensorSession::check_request_available(
+    api_Values api, const payload::ClientRequest &buff_recv,
+    payload::ServerResponse &buff_send) {
+    bool available = true;
+    switch (api) {
+    case OPEN:
+    case START:
+    case STOP:
+    case GET_AVAILABLE_MODES:
+    case GET_MODE_DETAILS:
+    case SET_MODE:
+    case SET_MODE_BY_INDEX:
+    case GET_SENSOR_CAPABILITIES:
+        available = frameSource != nullptr;
+        break;
+    case GET_AVAILABLE_CONTROLS:
+    case GET_CONTROL:
+    case INIT_TARGET_DEPTH_COMPUTE:
+    case ADSD3500_READ_CMD:
+    case ADSD3500_WRITE_CMD:
+    case ADSD3500_READ_PAYLOAD_CMD:
+    case ADSD3500_READ_PAYLOAD:
+    case ADSD3500_WRITE_PAYLOAD_CMD:
+    case ADSD3500_WRITE_PAYLOAD:
+    case ADSD3500_GET_STATUS:
+    case ADSD3500_BATCH:
+    case GET_DEPTH_COMPUTE_PARAM:
+    case SET_DEPTH_COMPUTE_PARAM:
+    case GET_INI_ARRAY:
+        available = camDepthSensor != nullptr;
+        break;
+    default:
+        break;
+    }
 
-                sensorsEnumerator->searchSensors();
-                sensorsEnumerator->getDepthSensors(depthSensors);
-                sensors_are_created = true;
-            }
+    if (!available) {
+        std::string errMsg = buff_recv.func_name() + " is not available " +
+                             (replayEnabled ? "when streaming a replay"
+                                            : "before FindSensors");
+        LOG(WARNING) << errMsg;
+        buff_send.set_message(errMsg);
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::UNAVAILABLE));
+    }
+    return available;
+}
 
-            /* Add information about available sensors */
+static void fill_mode_details(const aditof::DepthSensorModeDetails &details,
+                              payload::DepthSensorModeDetails *protoContent) {
+    protoContent->set_mode_number(details.modeNumber);
+    protoContent->set_pixel_format_index(details.pixelFormatIndex);
+    protoContent->set_frame_width_in_bytes(details.frameWidthInBytes);
+    protoContent->set_frame_height_in_bytes(details.frameHeightInBytes);
+    protoContent->set_base_resolution_width(details.baseResolutionWidth);
+    protoContent->set_base_resolution_height(details.baseResolutionHeight);
+    protoContent->set_metadata_size(details.metadataSize);
+    protoContent->set_is_pcm(details.isPCM);
+    protoContent->set_number_of_phases(details.numberOfPhases);
+    protoContent->set_number_of_frequencies(details.numberOfFrequencies);
+    for (const auto &content : details.frameContent) {
+        protoContent->add_frame_content(content);
+    }
+}
 
-            // Depth sensor
-            if (depthSensors.size() < 1) {
-                buff_send.set_message("No depth sensors are available");
-                buff_send.set_status(::payload::Status::UNREACHABLE);
-                break;
-            }
+// Depth compute parameters in the order GetDepthComputeParam sends them
+static const char *const depthComputeParamNames[] = {
+    "abThreshMin",       "abSumThresh",         "confThresh",
+    "radialThreshMin",   "radialThreshMax",     "jblfApplyFlag",
+    "jblfWindowSize",    "jblfGaussianSigma",   "jblfExponentialTerm",
+    "jblfMaxEdge",       "jblfABThreshold",     "headerSize"};
+
+// Turns the plane names of a request, as in frame_content of the mode
+// details, into FrameContent bits. Says which one is unknown in the reply.
+static aditof::Status
+parse_frame_content(const payload::ClientRequest &buff_recv, uint16_t &mask,
+                    payload::ServerResponse &buff_send) {
+    mask = 0;
+    for (int i = 0; i < buff_recv.func_strings_param_size(); ++i) {
+        auto content = frameContentNames.find(buff_recv.func_strings_param(i));
+        if (content == frameContentNames.end()) {
+            buff_send.set_message("Unknown frame content: " +
+                                  buff_recv.func_strings_param(i));
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+        mask |= content->second;
+    }
+    return aditof::Status::OK;
+}
 
-            camDepthSensor = depthSensors.front();
-            auto pbSensorsInfo = buff_send.mutable_sensors_info();
-            sensorV4lBufAccess =
-                std::dynamic_pointer_cast<aditof::V4lBufferAccessInterface>(
-                    camDepthSensor);
-
-            std::string name;
-            camDepthSensor->getName(name);
-            auto pbDepthSensorInfo = pbSensorsInfo->mutable_image_sensors();
-            pbDepthSensorInfo->set_name(name);
-
-            std::string kernelversion;
-            std::string ubootversion;
-            std::string sdversion;
-            auto cardVersion = buff_send.mutable_card_image_version();
-
-            sensorsEnumerator->getKernelVersion(kernelversion);
-            cardVersion->set_kernelversion(kernelversion);
-            sensorsEnumerator->getUbootVersion(ubootversion);
-            cardVersion->set_ubootversion(ubootversion);
-            sensorsEnumerator->getSdVersion(sdversion);
-            cardVersion->set_sdversion(sdversion);
-
-            // This server is now subscribing for interrupts of ADSD3500
-            aditof::Status registerCbStatus =
-                camDepthSensor->adsd3500_register_interrupt_callback(callback);
-            if (registerCbStatus != aditof::Status::OK) {
-                LOG(WARNING) << "Could not register callback";
-                // TBD: not sure whether to send this error to client or not
-            }
+// Reads x, y, width, height, decimation and optionally pooling (see
+// FramePooling) from the int32 parameters of a request, starting at first.
+// The region is checked against the current mode when there is one, a later
+// mode is checked at Start.
+aditof::Status
+SensorSession::parse_frame_region(const payload::ClientRequest &buff_recv,
+                                  int first, FrameRegion &region) {
+    const int count = buff_recv.func_int32_param_size() - first;
+    if (count < 5) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    for (int i = first; i < buff_recv.func_int32_param_size(); ++i) {
+        if (buff_recv.func_int32_param(i) < 0 ||
+            buff_recv.func_int32_param(i) > UINT16_MAX) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+    }
 
-            buff_send.set_status(
-                static_cast<::payload::Status>(aditof::Status::OK));
-            break;
+    region.x = static_cast<uint16_t>(buff_recv.func_int32_param(first));
+    region.y = static_cast<uint16_t>(buff_recv.func_int32_param(first + 1));
+    region.width = static_cast<uint16_t>(buff_recv.func_int32_param(first + 2));
+    region.height =
+        static_cast<uint16_t>(buff_recv.func_int32_param(first + 3));
+    region.decimation =
+        static_cast<uint16_t>(buff_recv.func_int32_param(first + 4));
+    if (count > 5) {
+        int pooling = buff_recv.func_int32_param(first + 5);
+        if (pooling > static_cast<int>(FramePooling::MEDIAN)) {
+            return aditof::Status::INVALID_ARGUMENT;
         }
+        region.pooling = static_cast<FramePooling>(pooling);
+    }
 
-        case OPEN: {
-            aditof::Status status = camDepthSensor->open();
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            clientEngagedWithSensors = true;
+    if (!currentFrame.width) {
+        return aditof::Status::OK;
+    }
+    FrameTransform transform;
+    return transform.configure(currentFrame.layout, currentFrame.width,
+                               currentFrame.height, currentFrame.planeCount,
+                               region);
+}
 
-            // At this stage, start the capturing frames thread
-            keepCaptureThreadAlive = true;
-            frameCaptureThread = std::thread(captureFrameFromHardware);
+// Requests that can run as jobs: the ones that can take long and only
+// work with the sensor
+static bool runs_as_job(api_Values api) {
+    switch (api) {
+    case INIT_TARGET_DEPTH_COMPUTE:
+    case GET_DEPTH_COMPUTE_PARAM:
+    case SET_DEPTH_COMPUTE_PARAM:
+    case GET_INI_ARRAY:
+    case ADSD3500_READ_PAYLOAD_CMD:
+    case ADSD3500_READ_PAYLOAD:
+    case ADSD3500_WRITE_PAYLOAD_CMD:
+    case ADSD3500_WRITE_PAYLOAD:
+    case ADSD3500_BATCH:
+    case GET_SENSOR_CAPABILITIES:
+        return true;
+    default:
+        return false;
+    }
+}
 
-            break;
-        }
+// Requests that use the sensor, or that jobs could change the outcome of.
+// GetFrame and the stream settings don't, so they are still served while a
+// job runs.
+static bool uses_sensor(api_Values api) {
+    switch (api) {
+    case OPEN:
+    case START:
+    case STOP:
+    case GET_AVAILABLE_MODES:
+    case GET_MODE_DETAILS:
+    case SET_MODE:
+    case SET_MODE_BY_INDEX:
+    case GET_AVAILABLE_CONTROLS:
+    case SET_CONTROL:
+    case GET_CONTROL:
+    case ADSD3500_READ_CMD:
+    case ADSD3500_WRITE_CMD:
+    case ADSD3500_GET_STATUS:
+        return true;
+    default:
+        return runs_as_job(api);
+    }
+}
 
-        case START: {
-            if (gotStream_off == true) {
-                gotStream_off =
-                    false; // reset this flag to expect the stream-off after start.
-            }
-            aditof::Status status = camDepthSensor->start();
-
-            // When in test mode, capture 2 frames. 1st might be corrupt after a ADSD3500 reset.
-            // 2nd frame will be the one sent over and over again by server in test mode.
-            if (sameFrameEndlessRepeat) {
-                for (int i = 0; i < 2; ++i) {
-                    status = camDepthSensor->getFrame(
-                        (uint16_t *)(buff_frame_to_send));
-                    if (status != aditof::Status::OK) {
-                        LOG(ERROR) << "Failed to get frame!";
-                    }
-                }
-            } else { // When in normal mode, trigger the capture thread to fetch a frame
-                {
-                    std::lock_guard<std::mutex> lock(frameMutex);
-                    goCaptureFrame = true;
-                }
-                cvGetFrame.notify_one();
-            }
+void SensorSession::handle_request(api_Values api,
+                                   const payload::ClientRequest &buff_recv,
+                                   payload::ServerResponse &buff_send) {
+    for (uint32_t id : jobs.takeFinished()) {
+        buff_send.add_jobs_done(id);
+    }
+    if (!check_request_available(api, buff_recv, buff_send)) {
+        // The reply already says why the request can't be served
+        return;
+    }
+    if (warm) {
+        rebind();
+    }
 
-            if (send_async == true) {
-                if (isConnectionClosed == false) {
-                    close_zmq_connection();
-                }
-                isConnectionClosed = false;
-                start_stream_thread(); // Start the stream_frame thread .
-            } else {
-                static zmq::context_t zmq_context(1);
-                server_socket = std::make_unique<zmq::socket_t>(
-                    zmq_context, zmq::socket_type::push);
-                server_socket->set(zmq::sockopt::sndhwm,
-                                   static_cast<int>(max_send_frames));
-                server_socket->set(zmq::sockopt::sndtimeo,
-                                   static_cast<int>(FRAME_TIMEOUT));
-                server_socket->bind("tcp://*:5555");
-                LOG(INFO) << "ZMQ server socket connection established.";
-            }
+    if (buff_recv.run_async()) {
+        submit_job(api, buff_recv, buff_send);
+    } else if (!uses_sensor(api)) {
+        execute_request(api, buff_recv, buff_send);
+    } else if (jobs.pending()) {
+        buff_send.set_message(buff_recv.func_name() +
+                              " waits for the jobs of the sensor");
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::BUSY));
+    } else {
+        std::unique_lock<std::mutex> sensor = lock_sensor();
+        execute_request(api, buff_recv, buff_send);
+    }
+}
 
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+// Queues the request for jobWorker. The reply gives the job id; the reply of
+// the request itself is read with GetJobStatus.
+void SensorSession::submit_job(api_Values api,
+                               const payload::ClientRequest &buff_recv,
+                               payload::ServerResponse &buff_send) {
+    if (!runs_as_job(api)) {
+        buff_send.set_message(buff_recv.func_name() + " can't run as a job");
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::INVALID_ARGUMENT));
+        return;
+    }
+    uint32_t id = jobs.add();
+    if (!id) {
+        buff_send.set_message("Too many jobs, read the replies of some");
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::BUSY));
+        return;
+    }
+
+    auto request = std::make_shared<payload::ClientRequest>(buff_recv);
+    auto queuedAt = std::chrono::steady_clock::now();
+    jobWorker.start(1);
+    jobWorker.submit([this, api, id, request, queuedAt]() {
+        if (!jobs.start(id)) {
+            return; // cancelled
         }
+        auto start = std::chrono::steady_clock::now();
+        jobQueuedDuration.record(start - queuedAt);
 
-        case STOP: {
-            if (gotStream_off ==
-                false) { // this operation will prevent to unecessary calling of stream-off
-                if (send_async == true) {
-                    stop_stream_thread();
-                }
-                aditof::Status status = camDepthSensor->stop();
-                if (status != aditof::Status::OK) {
-                    gotStream_off = false;
-                } else {
-                    gotStream_off = true;
-                }
-                buff_send.set_status(static_cast<::payload::Status>(status));
+        payload::ServerResponse reply;
+        reply.set_server_status(::payload::ServerStatus::REQUEST_ACCEPTED);
+        {
+            std::unique_lock<std::mutex> sensor = lock_sensor();
+            execute_request(api, *request, reply);
+        }
+        jobDuration.record(std::chrono::steady_clock::now() - start);
+        ++jobsRun;
+        jobs.finish(id, reply.SerializeAsString());
+    });
+
+    buff_send.set_job_id(id);
+    buff_send.set_job_state(::payload::JOB_QUEUED);
+    buff_send.set_status(static_cast<::payload::Status>(aditof::Status::OK));
+}
 
-                close_zmq_connection();
-            }
+void SensorSession::describe_job(const payload::ClientRequest &buff_recv,
+                                 payload::ServerResponse &buff_send) {
+    JobTable::State state;
+    std::string reply;
+    if (!jobs.take(buff_recv.job_id(), state, reply)) {
+        buff_send.set_message("No job " + std::to_string(buff_recv.job_id()));
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::INVALID_ARGUMENT));
+        return;
+    }
+    switch (state) {
+    case JobTable::State::QUEUED:
+        buff_send.set_job_state(::payload::JOB_QUEUED);
+        break;
+    case JobTable::State::RUNNING:
+        buff_send.set_job_state(::payload::JOB_RUNNING);
+        break;
+    case JobTable::State::DONE:
+        buff_send.set_job_state(::payload::JOB_DONE);
+        buff_send.mutable_job_result()->ParseFromString(reply);
+        break;
+    }
+    buff_send.set_job_id(buff_recv.job_id());
+    buff_send.set_status(static_cast<::payload::Status>(aditof::Status::OK));
+}
 
-            break;
-        }
+// Waits for the turn of the calling thread to use the sensor
+std::unique_lock<std::mutex> SensorSession::lock_sensor() {
+    std::lock_guard<std::mutex> turn(sensorTurn);
+    return std::unique_lock<std::mutex>(sensorMutex);
+}
 
-        case GET_AVAILABLE_MODES: {
-            std::vector<uint8_t> aditofModes;
-            aditof::Status status =
-                camDepthSensor->getAvailableModes(aditofModes);
-            for (auto &modeName : aditofModes) {
-                buff_send.add_int32_payload(modeName);
-            }
-            buff_send.set_status(static_cast<::payload::Status>(status));
+// Drops the queued jobs and waits for the running one
+void SensorSession::cancel_jobs() {
+    if (jobs.pending()) {
+        LOG(INFO) << "Cancelling the jobs of sensor " << index;
+    }
+    jobs.cancel();
+}
+
+void SensorSession::execute_request(api_Values api,
+                                    const payload::ClientRequest &buff_recv,
+                                    payload::ServerResponse &buff_send) {
+    switch (api) {
+    case OPEN: {
+        firstFrameFrom = clientConnectedAt;
+        firstFrameWarm = rebound;
+        firstFramePending = true;
+        if (frameCaptureThread.joinable()) {
+            // Still open, picked up warm or opened before
+            clientEngagedWithSensors = true;
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::OK));
             break;
         }
 
-        case GET_MODE_DETAILS: {
-            aditof::DepthSensorModeDetails frameDetails;
-            uint8_t modeName = buff_recv.func_int32_param(0);
-            aditof::Status status =
-                camDepthSensor->getModeDetails(modeName, frameDetails);
-            auto protoContent = buff_send.mutable_depth_sensor_mode_details();
-            protoContent->set_mode_number(frameDetails.modeNumber);
-            protoContent->set_pixel_format_index(frameDetails.pixelFormatIndex);
-            protoContent->set_frame_width_in_bytes(
-                frameDetails.frameWidthInBytes);
-            protoContent->set_frame_height_in_bytes(
-                frameDetails.frameHeightInBytes);
-            protoContent->set_base_resolution_width(
-                frameDetails.baseResolutionWidth);
-            protoContent->set_base_resolution_height(
-                frameDetails.baseResolutionHeight);
-            protoContent->set_metadata_size(frameDetails.metadataSize);
-            protoContent->set_is_pcm(frameDetails.isPCM);
-            protoContent->set_number_of_phases(frameDetails.numberOfPhases);
-            protoContent->set_number_of_frequencies(
-                frameDetails.numberOfFrequencies);
-            for (size_t i = 0; i < frameDetails.frameContent.size(); i++) {
-                protoContent->add_frame_content(
-                    frameDetails.frameContent.at(i));
-            }
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        aditof::Status status = frameSource->open();
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        clientEngagedWithSensors = true;
+        if (status == aditof::Status::OK) {
+            reserve_frame_buffers();
         }
 
-        case SET_MODE_BY_INDEX: {
+        // At this stage, start the capturing frames thread
+        keepCaptureThreadAlive = true;
+        frameCaptureThread =
+            std::thread(&SensorSession::captureFrameFromHardware, this);
+        captureWatchdogThread =
+            std::thread(&SensorSession::superviseFrameCapture, this);
 
-            uint8_t mode = buff_recv.func_int32_param(0);
+        break;
+    }
 
-            aditof::Status status = camDepthSensor->setMode(mode);
-            if (status == aditof::Status::OK) {
-                aditof::DepthSensorModeDetails aditofModeDetail;
-                status = camDepthSensor->getModeDetails(mode, aditofModeDetail);
+    case START: {
+        if (gotStream_off == true) {
+            gotStream_off =
+                false; // reset this flag to expect the stream-off after start.
+        }
+        aditof::Status status = frameSource->start();
+        rebound = false;
+
+        prepare_frame_region();
+        prepare_frame_content();
+        compressFrames =
+            buff_recv.compress_frames() && prepare_frame_compression();
+        // Over shared memory the server can't tell the frames a reader
+        // skipped, so it would reassemble stale tiles
+        const bool shmRequested =
+            buff_recv.frame_transport() == payload::FRAME_TRANSPORT_SHM;
+        if (buff_recv.tile_delta() && shmRequested) {
+            LOG(WARNING) << "Tiles can't be sent over shared memory";
+        }
+        tileDeltaFrames = !compressFrames && !shmRequested &&
+                          prepare_frame_tile_delta(buff_recv);
+        tileDeltaResync = false;
+        packFrames = !compressFrames && !tileDeltaFrames &&
+                     prepare_frame_packing(buff_recv);
+        buff_send.set_frame_encoding(
+            static_cast<payload::FrameEncoding>(current_frame_encoding()));
+        shmTransport = shmRequested && prepare_shm_transport();
+        buff_send.set_frame_transport(shmTransport
+                                          ? payload::FRAME_TRANSPORT_SHM
+                                          : payload::FRAME_TRANSPORT_TCP);
+        if (shmTransport) {
+            buff_send.set_shm_name(shmName);
+        } else {
+            buff_send.set_stream_port(streamPort);
+        }
+
+        // When in test mode, capture 2 frames. 1st might be corrupt after a ADSD3500 reset.
+        // 2nd frame will be the one sent over and over again by server in test mode.
+        if (sameFrameEndlessRepeat) {
+            for (int i = 0; i < 2; ++i) {
+                status = frameSource->getFrame(
+                    (uint16_t *)(buff_frame_to_send->data));
                 if (status != aditof::Status::OK) {
-                    buff_send.set_status(
-                        static_cast<::payload::Status>(status));
-                    break;
+                    LOG(ERROR) << "Failed to get frame!";
+                }
+            }
+        } else { // When in normal mode, trigger the capture thread to fetch a frame
+            drain_frame_ring();
+            frameSequence = 0;
+            captureCounter = 0;
+            captureNumbered = false;
+            {
+                std::lock_guard<std::mutex> lock(frameMutex);
+                captureFailed = false;
+                if (send_async) {
+                    captureFreeRunning = true;
+                } else {
+                    goCaptureFrame = true;
                 }
+            }
+            cvGetFrame.notify_all();
+        }
 
-                int width_tmp = aditofModeDetail.baseResolutionWidth;
-                int height_tmp = aditofModeDetail.baseResolutionHeight;
+        if (send_async == true) {
+            if (isConnectionClosed == false) {
+                close_zmq_connection();
+            }
+            isConnectionClosed = false;
+            start_stream_thread(); // Start the stream_frame thread .
+        } else {
+            server_socket = std::make_unique<zmq::socket_t>(
+                stream_context(), zmq::socket_type::push);
+            server_socket->set(zmq::sockopt::sndhwm,
+                               static_cast<int>(max_send_frames));
+            server_socket->set(zmq::sockopt::sndtimeo,
+                               static_cast<int>(FRAME_TIMEOUT));
+            server_socket->bind("tcp://*:" +
+                                std::to_string(streamPort));
+            LOG(INFO) << "ZMQ server socket connection established.";
+        }
 
-                if (aditofModeDetail.isPCM) {
-                    processedFrameSize = width_tmp * height_tmp *
-                                         aditofModeDetail.numberOfPhases;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-                } else {
-#ifdef DUAL
-                    if (mode == 1 || mode == 0) {
-                        processedFrameSize = width_tmp * height_tmp * 2;
-                    } else {
-                        processedFrameSize = width_tmp * height_tmp * 4;
-                    }
-#else
-                    processedFrameSize = width_tmp * height_tmp * 4;
-#endif
-                }
+    case STOP: {
+        if (gotStream_off ==
+            false) { // this operation will prevent to unecessary calling of stream-off
+            if (send_async == true) {
+                stop_stream_thread();
+            }
+            aditof::Status status = frameSource->stop();
+            if (status != aditof::Status::OK) {
+                gotStream_off = false;
+            } else {
+                gotStream_off = true;
+            }
+            buff_send.set_status(static_cast<::payload::Status>(status));
 
-                if (buff_frame_to_send != nullptr) {
-                    delete[] buff_frame_to_send;
-                    buff_frame_to_send = nullptr;
-                }
+            close_zmq_connection();
+        }
+        frameCredits = 0;
 
-                buff_frame_to_send =
-                    new uint8_t[processedFrameSize * sizeof(uint16_t)];
+        break;
+    }
 
-                if (buff_frame_to_be_captured != nullptr) {
-                    delete[] buff_frame_to_be_captured;
-                    buff_frame_to_be_captured = nullptr;
-                }
+    case GET_AVAILABLE_MODES: {
+        std::vector<uint8_t> aditofModes;
+        aditof::Status status =
+            frameSource->getAvailableModes(aditofModes);
+        for (auto &modeName : aditofModes) {
+            buff_send.add_int32_payload(modeName);
+        }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-                buff_frame_to_be_captured =
-                    new uint8_t[processedFrameSize * sizeof(uint16_t)];
+    case GET_MODE_DETAILS: {
+        aditof::DepthSensorModeDetails frameDetails;
+        uint8_t modeName = buff_recv.func_int32_param(0);
+        aditof::Status status =
+            frameSource->getModeDetails(modeName, frameDetails);
+        fill_mode_details(frameDetails,
+                          buff_send.mutable_depth_sensor_mode_details());
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-                buff_frame_length = processedFrameSize * 2;
-            }
+    case SET_MODE_BY_INDEX: {
 
-            buff_send.set_status(static_cast<::payload::Status>(status));
+        uint8_t mode = buff_recv.func_int32_param(0);
+        if (rebound && mode == activeMode) {
+            // Left in this mode by the previous client
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::OK));
             break;
         }
 
-        case SET_MODE: {
+        aditof::Status status = frameSource->setMode(mode);
+        if (status == aditof::Status::OK) {
+            activeMode = mode;
+            depthComputeIni.clear();
+            depthComputeCal.clear();
             aditof::DepthSensorModeDetails aditofModeDetail;
-            aditofModeDetail.modeNumber =
-                buff_recv.mode_details().mode_number();
-            aditofModeDetail.pixelFormatIndex =
-                buff_recv.mode_details().pixel_format_index();
-            aditofModeDetail.frameWidthInBytes =
-                buff_recv.mode_details().frame_width_in_bytes();
-            aditofModeDetail.frameHeightInBytes =
-                buff_recv.mode_details().frame_height_in_bytes();
-            aditofModeDetail.baseResolutionWidth =
-                buff_recv.mode_details().base_resolution_width();
-            aditofModeDetail.baseResolutionHeight =
-                buff_recv.mode_details().base_resolution_height();
-            aditofModeDetail.metadataSize =
-                buff_recv.mode_details().metadata_size();
-
-            for (int i = 0; i < buff_recv.mode_details().frame_content_size();
-                 i++) {
-                aditofModeDetail.frameContent.emplace_back(
-                    buff_recv.mode_details().frame_content(i));
+            status = frameSource->getModeDetails(mode, aditofModeDetail);
+            if (status != aditof::Status::OK) {
+                buff_send.set_status(
+                    static_cast<::payload::Status>(status));
+                break;
             }
 
-            aditof::Status status = camDepthSensor->setMode(aditofModeDetail);
+            int width_tmp = aditofModeDetail.baseResolutionWidth;
+            int height_tmp = aditofModeDetail.baseResolutionHeight;
 
-            if (status == aditof::Status::OK) {
-                int width_tmp = aditofModeDetail.baseResolutionWidth;
-                int height_tmp = aditofModeDetail.baseResolutionHeight;
+            if (aditofModeDetail.isPCM) {
+                processedFrameSize = width_tmp * height_tmp *
+                                     aditofModeDetail.numberOfPhases;
 
-                if (aditofModeDetail.isPCM) {
-                    processedFrameSize = width_tmp * height_tmp *
-                                         aditofModeDetail.numberOfPhases;
+            } else {
+#ifdef DUAL
+                if (mode == 1 || mode == 0) {
+                    processedFrameSize = width_tmp * height_tmp * 2;
                 } else {
                     processedFrameSize = width_tmp * height_tmp * 4;
                 }
+#else
+                processedFrameSize = width_tmp * height_tmp * 4;
+#endif
+            }
 
-                if (buff_frame_to_send != nullptr) {
-                    delete[] buff_frame_to_send;
-                    buff_frame_to_send = nullptr;
-                }
+            describe_frame(aditofModeDetail);
+            status = allocate_frame_buffers(processedFrameSize *
+                                            sizeof(uint16_t));
+        }
 
-                buff_frame_to_send =
-                    new uint8_t[processedFrameSize * sizeof(uint16_t)];
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-                if (buff_frame_to_be_captured != nullptr) {
-                    delete[] buff_frame_to_be_captured;
-                    buff_frame_to_be_captured = nullptr;
-                }
+    case SET_MODE: {
+        aditof::DepthSensorModeDetails aditofModeDetail;
+        aditofModeDetail.modeNumber =
+            buff_recv.mode_details().mode_number();
+        aditofModeDetail.pixelFormatIndex =
+            buff_recv.mode_details().pixel_format_index();
+        aditofModeDetail.frameWidthInBytes =
+            buff_recv.mode_details().frame_width_in_bytes();
+        aditofModeDetail.frameHeightInBytes =
+            buff_recv.mode_details().frame_height_in_bytes();
+        aditofModeDetail.baseResolutionWidth =
+            buff_recv.mode_details().base_resolution_width();
+        aditofModeDetail.baseResolutionHeight =
+            buff_recv.mode_details().base_resolution_height();
+        aditofModeDetail.metadataSize =
+            buff_recv.mode_details().metadata_size();
+
+        for (int i = 0; i < buff_recv.mode_details().frame_content_size();
+             i++) {
+            aditofModeDetail.frameContent.emplace_back(
+                buff_recv.mode_details().frame_content(i));
+        }
 
-                buff_frame_to_be_captured =
-                    new uint8_t[processedFrameSize * sizeof(uint16_t)];
+        if (rebound && aditofModeDetail.modeNumber == activeMode) {
+            // Left in this mode by the previous client
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::OK));
+            break;
+        }
+
+        aditof::Status status = frameSource->setMode(aditofModeDetail);
 
-                buff_frame_length = processedFrameSize * 2;
+        if (status == aditof::Status::OK) {
+            activeMode = aditofModeDetail.modeNumber;
+            depthComputeIni.clear();
+            depthComputeCal.clear();
+            int width_tmp = aditofModeDetail.baseResolutionWidth;
+            int height_tmp = aditofModeDetail.baseResolutionHeight;
+
+            if (aditofModeDetail.isPCM) {
+                processedFrameSize = width_tmp * height_tmp *
+                                     aditofModeDetail.numberOfPhases;
+            } else {
+                processedFrameSize = width_tmp * height_tmp * 4;
             }
 
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+            describe_frame(aditofModeDetail);
+            status = allocate_frame_buffers(processedFrameSize *
+                                            sizeof(uint16_t));
         }
 
-        case GET_FRAME: {
-            if (sameFrameEndlessRepeat) {
-                m_frame_ready = true;
-                zmq::message_t message(buff_frame_length);
-                memcpy(message.data(), buff_frame_to_send, buff_frame_length);
-                server_socket->send(message, zmq::send_flags::none);
-                buff_send.set_status(
-                    static_cast<::payload::Status>(aditof::Status::OK));
-                break;
-            } else {
-                // 1. Wait for frame to be captured on the other thread
-                std::unique_lock<std::mutex> lock(frameMutex);
-                cvGetFrame.wait(lock, []() { return frameCaptured; });
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-                // 2. Get your hands on the captured frame
-                std::swap(buff_frame_to_send, buff_frame_to_be_captured);
-                frameCaptured = false;
+    case GET_FRAME: {
+        if (sameFrameEndlessRepeat) {
+            if (!send_frame(buff_frame_to_send)) {
+                ++getFrameFailures;
+                buff_send.set_message("Failed to send the frame");
+                buff_send.set_status(static_cast<::payload::Status>(
+                    aditof::Status::GENERIC_ERROR));
+                break;
+            }
+            m_frame_ready = true;
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::OK));
+            break;
+        } else {
+            // 1. Wait for frame to be captured on the other thread. If it
+            // can't be, capture the next one for the next GetFrame.
+            std::unique_lock<std::mutex> lock(frameMutex);
+            bool ready = cvGetFrame.wait_for(
+                lock, get_frame_timeout + get_frame_wait_margin,
+                [this]() { return !frameRing.empty() || captureFailed; });
+            captureFailed = false;
+            if (!ready || frameRing.empty()) {
+                goCaptureFrame = true;
                 lock.unlock();
+                cvGetFrame.notify_all();
 
-                // 3. Trigger the other thread to capture another frame while we do stuff with current frame
-                {
-                    std::lock_guard<std::mutex> lock(frameMutex);
-                    goCaptureFrame = true;
-                }
-                cvGetFrame.notify_one();
+                ++getFrameFailures;
+                buff_send.set_message(ready ? "Failed to capture a frame"
+                                            : "Timeout waiting for a frame");
+                buff_send.set_status(static_cast<::payload::Status>(
+                    aditof::Status::GENERIC_ERROR));
+                break;
+            }
+            lock.unlock();
 
-                // 4. Send current frame over network
+            // 2. Get your hands on the captured frame
+            bool taken = take_captured_frame();
 
-                zmq::message_t message(buff_frame_length);
-                memcpy(message.data(), buff_frame_to_send, buff_frame_length);
-                server_socket->send(message, zmq::send_flags::none);
+            // 3. Trigger the other thread to capture another frame while we do stuff with current frame
+            {
+                std::lock_guard<std::mutex> lock(frameMutex);
+                goCaptureFrame = true;
+            }
+            cvGetFrame.notify_all();
+
+            if (!taken) {
+                ++getFrameFailures;
+                buff_send.set_message("The frame was captured in the previous "
+                                      "mode");
+                buff_send.set_status(static_cast<::payload::Status>(
+                    aditof::Status::GENERIC_ERROR));
+                break;
+            }
 
-                m_frame_ready = true;
+            // 4. Send current frame over network, ZMQ reads it straight from the pool
 
-                buff_send.set_status(payload::Status::OK);
+            if (!send_frame(buff_frame_to_send)) {
+                ++getFrameFailures;
+                buff_send.set_message("Failed to send the frame");
+                buff_send.set_status(static_cast<::payload::Status>(
+                    aditof::Status::GENERIC_ERROR));
                 break;
             }
-        }
 
-        case GET_AVAILABLE_CONTROLS: {
-            std::vector<std::string> aditofControls;
+            m_frame_ready = true;
 
-            aditof::Status status =
-                camDepthSensor->getAvailableControls(aditofControls);
-            for (const auto &aditofControl : aditofControls) {
-                buff_send.add_strings_payload(aditofControl);
-            }
-            buff_send.set_status(static_cast<::payload::Status>(status));
+            buff_send.set_status(payload::Status::OK);
             break;
         }
+    }
 
-        case SET_CONTROL: {
-            std::string controlName = buff_recv.func_strings_param(0);
-            std::string controlValue = buff_recv.func_strings_param(1);
-            aditof::Status status =
-                camDepthSensor->setControl(controlName, controlValue);
-            if (controlName == "netlinktest") {
-                sameFrameEndlessRepeat = controlValue == "1";
-            }
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+    case GET_AVAILABLE_CONTROLS: {
+        std::vector<std::string> aditofControls;
+
+        aditof::Status status =
+            camDepthSensor->getAvailableControls(aditofControls);
+        for (const auto &aditofControl : aditofControls) {
+            buff_send.add_strings_payload(aditofControl);
         }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-        case GET_CONTROL: {
-            std::string controlName = buff_recv.func_strings_param(0);
-            std::string controlValue;
-            aditof::Status status =
-                camDepthSensor->getControl(controlName, controlValue);
-            buff_send.add_strings_payload(controlValue);
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+    case SET_CONTROL: {
+        std::string controlName = buff_recv.func_strings_param(0);
+        std::string controlValue = buff_recv.func_strings_param(1);
+        aditof::Status status = aditof::Status::UNAVAILABLE;
+        if (camDepthSensor) {
+            status = camDepthSensor->setControl(controlName, controlValue);
+        } else if (controlName == "netlinktest") {
+            status = aditof::Status::OK;
+        }
+        if (controlName == "netlinktest") {
+            sameFrameEndlessRepeat = controlValue == "1";
         }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-        case INIT_TARGET_DEPTH_COMPUTE: {
-            aditof::Status status = camDepthSensor->initTargetDepthCompute(
-                (uint8_t *)buff_recv.func_bytes_param(0).c_str(),
-                static_cast<uint16_t>(buff_recv.func_int32_param(0)),
-                (uint8_t *)buff_recv.func_bytes_param(1).c_str(),
-                static_cast<uint16_t>(buff_recv.func_int32_param(1)));
+    case GET_CONTROL: {
+        std::string controlName = buff_recv.func_strings_param(0);
+        std::string controlValue;
+        aditof::Status status =
+            camDepthSensor->getControl(controlName, controlValue);
+        buff_send.add_strings_payload(controlValue);
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            buff_send.set_status(static_cast<::payload::Status>(status));
+    case INIT_TARGET_DEPTH_COMPUTE: {
+        if (rebound && buff_recv.func_bytes_param(0) == depthComputeIni &&
+            buff_recv.func_bytes_param(1) == depthComputeCal) {
+            // Already initialized with this data by the previous client
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::OK));
             break;
         }
 
-        case ADSD3500_READ_CMD: {
-            uint16_t cmd = static_cast<uint16_t>(buff_recv.func_int32_param(0));
-            uint16_t data;
-            unsigned int usDelay =
-                static_cast<unsigned int>(buff_recv.func_int32_param(1));
+        aditof::Status status = camDepthSensor->initTargetDepthCompute(
+            (uint8_t *)buff_recv.func_bytes_param(0).c_str(),
+            static_cast<uint16_t>(buff_recv.func_int32_param(0)),
+            (uint8_t *)buff_recv.func_bytes_param(1).c_str(),
+            static_cast<uint16_t>(buff_recv.func_int32_param(1)));
+        if (status == aditof::Status::OK) {
+            depthComputeIni = buff_recv.func_bytes_param(0);
+            depthComputeCal = buff_recv.func_bytes_param(1);
+        }
 
-            aditof::Status status =
-                camDepthSensor->adsd3500_read_cmd(cmd, &data, usDelay);
-            if (status == aditof::Status::OK) {
-                buff_send.add_int32_payload(static_cast<::google::int32>(data));
-            }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+    case ADSD3500_READ_CMD: {
+        uint16_t cmd = static_cast<uint16_t>(buff_recv.func_int32_param(0));
+        uint16_t data;
+        unsigned int usDelay =
+            static_cast<unsigned int>(buff_recv.func_int32_param(1));
+
+        aditof::Status status =
+            camDepthSensor->adsd3500_read_cmd(cmd, &data, usDelay);
+        if (status == aditof::Status::OK) {
+            buff_send.add_int32_payload(static_cast<::google::int32>(data));
         }
 
-        case ADSD3500_WRITE_CMD: {
-            uint16_t cmd = static_cast<uint16_t>(buff_recv.func_int32_param(0));
-            uint16_t data =
-                static_cast<uint16_t>(buff_recv.func_int32_param(1));
-            uint32_t usDelay =
-                static_cast<uint32_t>(buff_recv.func_int32_param(2));
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+
+    case ADSD3500_WRITE_CMD: {
+        uint16_t cmd = static_cast<uint16_t>(buff_recv.func_int32_param(0));
+        uint16_t data =
+            static_cast<uint16_t>(buff_recv.func_int32_param(1));
+        uint32_t usDelay =
+            static_cast<uint32_t>(buff_recv.func_int32_param(2));
 
-            aditof::Status status =
-                camDepthSensor->adsd3500_write_cmd(cmd, data, usDelay);
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        aditof::Status status =
+            camDepthSensor->adsd3500_write_cmd(cmd, data, usDelay);
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+
+    case ADSD3500_READ_PAYLOAD_CMD: {
+        uint32_t cmd = static_cast<uint32_t>(buff_recv.func_int32_param(0));
+        uint16_t payload_len =
+            static_cast<uint16_t>(buff_recv.func_int32_param(1));
+        uint8_t *data = new uint8_t[payload_len];
+
+        memcpy(data, buff_recv.func_bytes_param(0).c_str(),
+               4 * sizeof(uint8_t));
+        aditof::Status status = camDepthSensor->adsd3500_read_payload_cmd(
+            cmd, data, payload_len);
+        if (status == aditof::Status::OK) {
+            buff_send.add_bytes_payload(data, payload_len);
         }
 
-        case ADSD3500_READ_PAYLOAD_CMD: {
-            uint32_t cmd = static_cast<uint32_t>(buff_recv.func_int32_param(0));
-            uint16_t payload_len =
-                static_cast<uint16_t>(buff_recv.func_int32_param(1));
-            uint8_t *data = new uint8_t[payload_len];
+        delete[] data;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            memcpy(data, buff_recv.func_bytes_param(0).c_str(),
-                   4 * sizeof(uint8_t));
-            aditof::Status status = camDepthSensor->adsd3500_read_payload_cmd(
-                cmd, data, payload_len);
-            if (status == aditof::Status::OK) {
-                buff_send.add_bytes_payload(data, payload_len);
-            }
+    case ADSD3500_READ_PAYLOAD: {
+        uint16_t payload_len =
+            static_cast<uint16_t>(buff_recv.func_int32_param(0));
+        uint8_t *data = new uint8_t[payload_len];
 
-            delete[] data;
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        aditof::Status status =
+            camDepthSensor->adsd3500_read_payload(data, payload_len);
+        if (status == aditof::Status::OK) {
+            buff_send.add_bytes_payload(data, payload_len);
         }
 
-        case ADSD3500_READ_PAYLOAD: {
-            uint16_t payload_len =
-                static_cast<uint16_t>(buff_recv.func_int32_param(0));
-            uint8_t *data = new uint8_t[payload_len];
+        delete[] data;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            aditof::Status status =
-                camDepthSensor->adsd3500_read_payload(data, payload_len);
-            if (status == aditof::Status::OK) {
-                buff_send.add_bytes_payload(data, payload_len);
-            }
+    case ADSD3500_WRITE_PAYLOAD_CMD: {
+        uint32_t cmd = static_cast<uint32_t>(buff_recv.func_int32_param(0));
+        uint16_t payload_len =
+            static_cast<uint16_t>(buff_recv.func_int32_param(1));
+        uint8_t *data = new uint8_t[payload_len];
+
+        memcpy(data, buff_recv.func_bytes_param(0).c_str(), payload_len);
+        aditof::Status status = camDepthSensor->adsd3500_write_payload_cmd(
+            cmd, data, payload_len);
+        if (status == aditof::Status::OK) {
+            // May have written the firmware or the CCB
+            capabilities.reset();
+        }
 
-            delete[] data;
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        delete[] data;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+
+    case ADSD3500_WRITE_PAYLOAD: {
+        uint16_t payload_len =
+            static_cast<uint16_t>(buff_recv.func_int32_param(0));
+        uint8_t *data = new uint8_t[payload_len];
+
+        memcpy(data, buff_recv.func_bytes_param(0).c_str(), payload_len);
+        aditof::Status status =
+            camDepthSensor->adsd3500_write_payload(data, payload_len);
+        if (status == aditof::Status::OK) {
+            // May have written the firmware or the CCB
+            capabilities.reset();
         }
 
-        case ADSD3500_WRITE_PAYLOAD_CMD: {
-            uint32_t cmd = static_cast<uint32_t>(buff_recv.func_int32_param(0));
-            uint16_t payload_len =
-                static_cast<uint16_t>(buff_recv.func_int32_param(1));
-            uint8_t *data = new uint8_t[payload_len];
+        delete[] data;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            memcpy(data, buff_recv.func_bytes_param(0).c_str(), payload_len);
-            aditof::Status status = camDepthSensor->adsd3500_write_payload_cmd(
-                cmd, data, payload_len);
+    case ADSD3500_GET_STATUS: {
+        int chipStatus;
+        int imagerStatus;
 
-            delete[] data;
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        aditof::Status status =
+            camDepthSensor->adsd3500_get_status(chipStatus, imagerStatus);
+        if (status == aditof::Status::OK) {
+            buff_send.add_int32_payload(chipStatus);
+            buff_send.add_int32_payload(imagerStatus);
         }
 
-        case ADSD3500_WRITE_PAYLOAD: {
-            uint16_t payload_len =
-                static_cast<uint16_t>(buff_recv.func_int32_param(0));
-            uint8_t *data = new uint8_t[payload_len];
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            memcpy(data, buff_recv.func_bytes_param(0).c_str(), payload_len);
-            aditof::Status status =
-                camDepthSensor->adsd3500_write_payload(data, payload_len);
+    case ADSD3500_BATCH: {
+        aditof::Status status = aditof::Status::OK;
+        for (int i = 0; i < buff_recv.adsd3500_ops_size(); ++i) {
+            auto result = buff_send.add_adsd3500_results();
+            status = run_adsd3500_op(buff_recv.adsd3500_ops(i), *result);
+            result->set_status(static_cast<::payload::Status>(status));
+            ++adsd3500BatchOps;
+            if (status != aditof::Status::OK) {
+                buff_send.set_message("Command " + std::to_string(i) +
+                                      " of the batch failed");
+                break;
+            }
+        }
+        ++adsd3500Batches;
 
-            delete[] data;
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+
+    case GET_INTERRUPTS: {
+        std::lock_guard<std::mutex> lock(interruptMutex);
+        for (aditof::Adsd3500Status status : pendingInterrupts) {
+            buff_send.add_int32_payload(static_cast<int>(status));
         }
+        pendingInterrupts.clear();
+
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::OK));
+        break;
+    }
 
-        case ADSD3500_GET_STATUS: {
-            int chipStatus;
-            int imagerStatus;
+    case HANG_UP: {
+        // Same teardown as when the client disconnects: the stream threads
+        // use the settings and the shared memory cleanup_sensors() resets
+        cancel_jobs();
+        stop_stream_thread();
+        if (isConnectionClosed == false) {
+            std::unique_lock<std::mutex> sensor = lock_sensor();
+            close_zmq_connection();
+        }
+        if (frameSource) {
+            cleanup_sensors();
+        }
+        clientEngagedWithSensors = false;
+        release_sensors_if_unused();
+
+        break;
+    }
 
-            aditof::Status status =
-                camDepthSensor->adsd3500_get_status(chipStatus, imagerStatus);
-            if (status == aditof::Status::OK) {
-                buff_send.add_int32_payload(chipStatus);
-                buff_send.add_int32_payload(imagerStatus);
+    case GET_DEPTH_COMPUTE_PARAM: {
+        std::map<std::string, std::string> ini_params;
+        aditof::Status status =
+            camDepthSensor->getDepthComputeParams(ini_params);
+        if (status == aditof::Status::OK) {
+            for (const char *name : depthComputeParamNames) {
+                buff_send.add_strings_payload(ini_params[name]);
             }
+        }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+    case SET_DEPTH_COMPUTE_PARAM: {
+        std::map<std::string, std::string> ini_params;
+        ini_params["abThreshMin"] = buff_recv.func_strings_param(0);
+        ini_params["abSumThresh"] = buff_recv.func_strings_param(1);
+        ini_params["confThresh"] = buff_recv.func_strings_param(2);
+        ini_params["radialThreshMin"] = buff_recv.func_strings_param(3);
+        ini_params["radialThreshMax"] = buff_recv.func_strings_param(4);
+        ini_params["jblfApplyFlag"] = buff_recv.func_strings_param(5);
+        ini_params["jblfWindowSize"] = buff_recv.func_strings_param(6);
+        ini_params["jblfGaussianSigma"] = buff_recv.func_strings_param(7);
+        ini_params["jblfExponentialTerm"] = buff_recv.func_strings_param(8);
+        ini_params["jblfMaxEdge"] = buff_recv.func_strings_param(9);
+        ini_params["jblfABThreshold"] = buff_recv.func_strings_param(10);
+
+        aditof::Status status =
+            camDepthSensor->setDepthComputeParams(ini_params);
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+
+    case GET_SENSOR_CAPABILITIES: {
+        describe_capabilities(buff_send);
+        break;
+    }
+
+    case GET_JOB_STATUS: {
+        describe_job(buff_recv, buff_send);
+        break;
+    }
+
+    case GET_INI_ARRAY: {
+        int mode = buff_recv.func_int32_param(0);
+        std::string iniStr;
+
+        aditof::Status status =
+            camDepthSensor->getIniParamsArrayForMode(mode, iniStr);
+
+        if (status == aditof::Status::OK) {
+            buff_send.add_strings_payload(iniStr);
         }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+    case SET_FRAME_HEADER: {
+        frameHeaderEnabled = buff_recv.func_int32_param_size() > 0 &&
+                             buff_recv.func_int32_param(0) != 0;
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::OK));
+        break;
+    }
 
-        case GET_INTERRUPTS: {
+    case SET_FRAME_CONTENT: {
+        // Nothing selects whole frames again. Applied at the next Start.
+        uint16_t mask = 0;
+        aditof::Status status =
+            parse_frame_content(buff_recv, mask, buff_send);
+        if (status == aditof::Status::OK) {
+            frameContentMask = mask;
+        }
 
-            {
-                if (adsd3500InterruptsQueueMutex.try_lock_for(
-                        std::chrono::milliseconds(500))) {
-                    while (!adsd3500InterruptsQueue.empty()) {
-                        buff_send.add_int32_payload(
-                            (int)adsd3500InterruptsQueue.front());
-                        adsd3500InterruptsQueue.pop();
-                    }
-                    adsd3500InterruptsQueueMutex.unlock();
-                } else {
-                    LOG(ERROR) << "Unable to lock adsd3500InterruptsQueueMutex "
-                                  "in 500 ms";
-                }
-            }
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            buff_send.set_status(
-                static_cast<::payload::Status>(aditof::Status::OK));
-            break;
+    case REQUEST_KEYFRAME: {
+        // For a client that lost track of the tiles, e.g. after missing
+        // a frame
+        tileEncoder.requestKeyframe();
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::OK));
+        break;
+    }
+
+    case SET_FRAME_REGION: {
+        // A width or height of 0 crops nothing. Applied at the next
+        // Start.
+        FrameRegion region;
+        aditof::Status status = parse_frame_region(buff_recv, 0, region);
+        if (status == aditof::Status::OK) {
+            frameRegion = region;
+        } else {
+            buff_send.set_message("Invalid frame region");
         }
 
-        case HANG_UP: {
-            if (sensors_are_created) {
-                cleanup_sensors();
-            }
-            clientEngagedWithSensors = false;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
+    case SUBSCRIBE: {
+        // Queue depth, drop policy (0 oldest, 1 newest) and the region
+        // as for SetFrameRegion, all optional, and the planes as for
+        // SetFrameContent. Replies with the subscriber id and the port
+        // to pull its frames from.
+        if (!maxSubscribers) {
+            buff_send.set_message("Fan-out is disabled, start the "
+                                  "server with --fan-out");
+            buff_send.set_status(static_cast<::payload::Status>(
+                aditof::Status::UNAVAILABLE));
             break;
         }
 
-        case GET_DEPTH_COMPUTE_PARAM: {
-            std::map<std::string, std::string> ini_params;
-            aditof::Status status =
-                camDepthSensor->getDepthComputeParams(ini_params);
-            if (status == aditof::Status::OK) {
-                buff_send.add_strings_payload(ini_params["abThreshMin"]);
-                buff_send.add_strings_payload(ini_params["abSumThresh"]);
-                buff_send.add_strings_payload(ini_params["confThresh"]);
-                buff_send.add_strings_payload(ini_params["radialThreshMin"]);
-                buff_send.add_strings_payload(ini_params["radialThreshMax"]);
-                buff_send.add_strings_payload(ini_params["jblfApplyFlag"]);
-                buff_send.add_strings_payload(ini_params["jblfWindowSize"]);
-                buff_send.add_strings_payload(ini_params["jblfGaussianSigma"]);
-                buff_send.add_strings_payload(
-                    ini_params["jblfExponentialTerm"]);
-                buff_send.add_strings_payload(ini_params["jblfMaxEdge"]);
-                buff_send.add_strings_payload(ini_params["jblfABThreshold"]);
-                buff_send.add_strings_payload(ini_params["headerSize"]);
+        SubscriberOptions options;
+        aditof::Status status = aditof::Status::OK;
+        const int params = buff_recv.func_int32_param_size();
+        if (params > 0) {
+            int depth = buff_recv.func_int32_param(0);
+            if (depth < 1 ||
+                depth > static_cast<int>(FrameFanout::MAX_QUEUE_DEPTH)) {
+                buff_send.set_message("Invalid subscriber queue depth");
+                status = aditof::Status::INVALID_ARGUMENT;
+            }
+            options.queueDepth = static_cast<size_t>(depth);
+        }
+        if (params > 1) {
+            int policy = buff_recv.func_int32_param(1);
+            if (policy != 0 && policy != 1) {
+                buff_send.set_message("Invalid subscriber drop policy");
+                status = aditof::Status::INVALID_ARGUMENT;
+            }
+            options.dropPolicy = policy == 1 ? DropPolicy::DROP_NEWEST
+                                             : DropPolicy::DROP_OLDEST;
+        }
+        if (status == aditof::Status::OK && params > 2) {
+            status = parse_frame_region(buff_recv, 2, options.region);
+            if (status != aditof::Status::OK) {
+                buff_send.set_message("Invalid frame region");
             }
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        }
+        if (status == aditof::Status::OK) {
+            status =
+                parse_frame_content(buff_recv, options.content, buff_send);
         }
 
-        case SET_DEPTH_COMPUTE_PARAM: {
-            std::map<std::string, std::string> ini_params;
-            ini_params["abThreshMin"] = buff_recv.func_strings_param(0);
-            ini_params["abSumThresh"] = buff_recv.func_strings_param(1);
-            ini_params["confThresh"] = buff_recv.func_strings_param(2);
-            ini_params["radialThreshMin"] = buff_recv.func_strings_param(3);
-            ini_params["radialThreshMax"] = buff_recv.func_strings_param(4);
-            ini_params["jblfApplyFlag"] = buff_recv.func_strings_param(5);
-            ini_params["jblfWindowSize"] = buff_recv.func_strings_param(6);
-            ini_params["jblfGaussianSigma"] = buff_recv.func_strings_param(7);
-            ini_params["jblfExponentialTerm"] = buff_recv.func_strings_param(8);
-            ini_params["jblfMaxEdge"] = buff_recv.func_strings_param(9);
-            ini_params["jblfABThreshold"] = buff_recv.func_strings_param(10);
-
-            aditof::Status status =
-                camDepthSensor->setDepthComputeParams(ini_params);
-            buff_send.set_status(static_cast<::payload::Status>(status));
-            break;
+        uint32_t id = 0;
+        uint16_t port = 0;
+        if (status == aditof::Status::OK) {
+            status = frameFanout.subscribe(options, id, port);
+            if (status == aditof::Status::BUSY) {
+                buff_send.set_message("All subscriber slots are taken");
+            }
+        }
+        if (status == aditof::Status::OK) {
+            buff_send.add_int32_payload(static_cast<int32_t>(id));
+            buff_send.add_int32_payload(port);
         }
 
-        case GET_INI_ARRAY: {
-            int mode = buff_recv.func_int32_param(0);
-            std::string iniStr;
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
 
-            aditof::Status status =
-                camDepthSensor->getIniParamsArrayForMode(mode, iniStr);
+    case UNSUBSCRIBE: {
+        aditof::Status status = aditof::Status::INVALID_ARGUMENT;
+        if (buff_recv.func_int32_param_size() > 0) {
+            status = frameFanout.unsubscribe(
+                static_cast<uint32_t>(buff_recv.func_int32_param(0)));
+        }
 
-            if (status == aditof::Status::OK) {
-                buff_send.add_strings_payload(iniStr);
-            }
-            buff_send.set_status(static_cast<::payload::Status>(status));
+        buff_send.set_status(static_cast<::payload::Status>(status));
+        break;
+    }
+
+    case GRANT_FRAME_CREDITS: {
+        // Credits are only read by the stream thread, so switching to
+        // credit mode is done before Start and stays until disconnect
+        if (!frameCreditsEnabled && running) {
+            buff_send.set_message(
+                "Frame credits must be granted before Start");
+            buff_send.set_status(static_cast<::payload::Status>(
+                aditof::Status::BUSY));
             break;
         }
-        case SERVER_CONNECT: {
-            if (!no_of_client_connected) {
-                buff_send.set_message("Connection Allowed");
-            } else {
-                buff_send.set_message("Only 1 client connection allowed");
-            }
+
+        int32_t grant = buff_recv.func_int32_param_size() > 0
+                            ? buff_recv.func_int32_param(0)
+                            : 0;
+        if (grant < 0) {
+            buff_send.set_status(static_cast<::payload::Status>(
+                aditof::Status::INVALID_ARGUMENT));
             break;
         }
 
-        case RECV_ASYNC: {
+        {
+            std::lock_guard<std::mutex> lock(frameMutex);
+            frameCreditsEnabled = true;
             send_async = true;
-            buff_send.set_message("send_async");
+            frameCredits = std::min<uint32_t>(
+                frameCredits + static_cast<uint32_t>(grant),
+                max_send_frames);
+        }
+        cvGetFrame.notify_all();
 
-            break;
+        buff_send.add_int32_payload(static_cast<int32_t>(frameCredits));
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::OK));
+        break;
+    }
+
+    case RECV_ASYNC: {
+        send_async = true;
+        buff_send.set_message("send_async");
+
+        break;
+    }
+
+    default: {
+        std::string msgErr = "Function not found";
+        std::cout << msgErr << "\n";
+
+        buff_send.set_message(msgErr);
+        buff_send.set_server_status(
+            ::payload::ServerStatus::REQUEST_UNKNOWN);
+        break;
+    }
+    } // switch
+}
+
+void SensorSession::set_interrupt_flag(payload::ServerResponse &buff_send) {
+    std::lock_guard<std::mutex> lock(interruptMutex);
+    buff_send.set_interrupt_occured(!pendingInterrupts.empty());
+}
+
+// Takes the interrupts queued by the callback, publishes them and keeps
+// them for GetInterrupts. Interrupt publisher thread only.
+void SensorSession::publish_interrupts() {
+    InterruptEvent event;
+    while (interruptQueue.pop(event)) {
+        auto status = static_cast<aditof::Adsd3500Status>(event.status);
+        DLOG(INFO) << "ADSD3500 interrupt occured on sensor " << index
+                   << ": status = " << status;
+        {
+            std::lock_guard<std::mutex> lock(interruptMutex);
+            pendingInterrupts.push_back(status);
+        }
+        const uint64_t sequence = ++interruptsPublished;
+        if (!interrupt_pub) {
+            continue;
         }
 
-        default: {
-            std::string msgErr = "Function not found";
-            std::cout << msgErr << "\n";
+        const uint64_t dropped = interruptsDropped.load();
+        InterruptMessage message = {};
+        message.magic = INTERRUPT_MESSAGE_MAGIC;
+        message.version = INTERRUPT_MESSAGE_VERSION;
+        message.sensor = static_cast<uint16_t>(index);
+        message.status = event.status;
+        message.dropped =
+            static_cast<uint32_t>(dropped - interruptsDroppedReported);
+        message.sequence = sequence;
+        message.timestamp = event.timestamp;
+        interruptsDroppedReported = dropped;
+
+        // A PUB socket drops rather than blocks when a subscriber lags
+        zmq::message_t part(&message, sizeof(message));
+        interrupt_pub->send(part, zmq::send_flags::dontwait);
+    }
+}
 
-            buff_send.set_message(msgErr);
-            buff_send.set_server_status(
-                ::payload::ServerStatus::REQUEST_UNKNOWN);
-            break;
+void SensorSession::attach_sensor(
+    std::shared_ptr<aditof::DepthSensorInterface> sensor) {
+    camDepthSensor = sensor;
+    frameSource = std::make_shared<SensorFrameSource>(camDepthSensor);
+    capabilities.reset();
+    sensorV4lBufAccess =
+        std::dynamic_pointer_cast<aditof::V4lBufferAccessInterface>(
+            camDepthSensor);
+
+    // This server is now subscribing for interrupts of ADSD3500
+    aditof::Status registerCbStatus =
+        camDepthSensor->adsd3500_register_interrupt_callback(callback);
+    if (registerCbStatus != aditof::Status::OK) {
+        LOG(WARNING) << "Could not register callback";
+        // TBD: not sure whether to send this error to client or not
+    }
+}
+
+// Runs one command of an Adsd3500Batch request the way the request of the
+// same name would, then waits for its delay. Read and write commands hand
+// the delay to the sensor like Adsd3500ReadCmd and Adsd3500WriteCmd do.
+aditof::Status
+SensorSession::run_adsd3500_op(const payload::Adsd3500Op &op,
+                               payload::Adsd3500OpResult &result) {
+    const bool isCmd = op.type() == payload::ADSD3500_OP_READ_CMD ||
+                       op.type() == payload::ADSD3500_OP_WRITE_CMD;
+    if ((isCmd && (op.cmd() > UINT16_MAX || op.value() > UINT16_MAX)) ||
+        op.payload_length() > UINT16_MAX) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    const uint16_t cmd = static_cast<uint16_t>(op.cmd());
+    const uint16_t length = static_cast<uint16_t>(op.payload_length());
+    const std::string &payload = op.payload();
+    std::vector<uint8_t> data(length);
+
+    aditof::Status status = aditof::Status::INVALID_ARGUMENT;
+    switch (op.type()) {
+    case payload::ADSD3500_OP_READ_CMD: {
+        uint16_t value = 0;
+        status = camDepthSensor->adsd3500_read_cmd(cmd, &value, op.delay_us());
+        if (status == aditof::Status::OK) {
+            result.set_value(value);
+        }
+        return status;
+    }
+    case payload::ADSD3500_OP_WRITE_CMD:
+        return camDepthSensor->adsd3500_write_cmd(
+            cmd, static_cast<uint16_t>(op.value()), op.delay_us());
+    case payload::ADSD3500_OP_READ_PAYLOAD_CMD:
+        // The payload holds the arguments of the command, e.g. an address
+        memcpy(data.data(), payload.data(),
+               std::min(payload.size(), data.size()));
+        status = camDepthSensor->adsd3500_read_payload_cmd(op.cmd(),
+                                                           data.data(), length);
+        break;
+    case payload::ADSD3500_OP_READ_PAYLOAD:
+        status = camDepthSensor->adsd3500_read_payload(data.data(), length);
+        break;
+    case payload::ADSD3500_OP_WRITE_PAYLOAD_CMD:
+    case payload::ADSD3500_OP_WRITE_PAYLOAD:
+        if (payload.size() < length) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+        memcpy(data.data(), payload.data(), length);
+        status = op.type() == payload::ADSD3500_OP_WRITE_PAYLOAD
+                     ? camDepthSensor->adsd3500_write_payload(data.data(),
+                                                              length)
+                     : camDepthSensor->adsd3500_write_payload_cmd(
+                           op.cmd(), data.data(), length);
+        if (status == aditof::Status::OK) {
+            // May have written the firmware or the CCB
+            capabilities.reset();
+        }
+        break;
+    default:
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    if (status == aditof::Status::OK &&
+        (op.type() == payload::ADSD3500_OP_READ_PAYLOAD_CMD ||
+         op.type() == payload::ADSD3500_OP_READ_PAYLOAD)) {
+        result.set_payload(data.data(), length);
+    }
+    if (op.delay_us()) {
+        std::this_thread::sleep_for(std::chrono::microseconds(op.delay_us()));
+    }
+    return status;
+}
+
+// Versions of the SD card image, empty for a replay
+static void fill_card_image_version(payload::CardImageVersion *cardVersion) {
+    if (!sensorsEnumerator) {
+        return;
+    }
+    std::string kernelversion;
+    std::string ubootversion;
+    std::string sdversion;
+
+    sensorsEnumerator->getKernelVersion(kernelversion);
+    cardVersion->set_kernelversion(kernelversion);
+    sensorsEnumerator->getUbootVersion(ubootversion);
+    cardVersion->set_ubootversion(ubootversion);
+    sensorsEnumerator->getSdVersion(sdversion);
+    cardVersion->set_sdversion(sdversion);
+}
+
+// Reads what GetAvailableModes, GetModeDetails, GetIniArray and
+// GetAvailableControls would return. The ini arrays may not be readable yet,
+// before Open for instance; they are then left empty and complete is false.
+aditof::Status
+SensorSession::build_capabilities(payload::SensorCapabilities &caps,
+                                  bool &complete) {
+    complete = true;
+
+    std::string name;
+    frameSource->getName(name);
+    caps.set_name(name);
+    fill_card_image_version(caps.mutable_card_image_version());
+
+    std::vector<uint8_t> modes;
+    aditof::Status status = frameSource->getAvailableModes(modes);
+    if (status != aditof::Status::OK) {
+        return status;
+    }
+    for (uint8_t mode : modes) {
+        aditof::DepthSensorModeDetails details;
+        status = frameSource->getModeDetails(mode, details);
+        if (status != aditof::Status::OK) {
+            return status;
+        }
+        caps.add_available_modes(mode);
+        auto modeCaps = caps.add_modes();
+        fill_mode_details(details, modeCaps->mutable_details());
+
+        // A replay has no sensor to read them from
+        if (camDepthSensor) {
+            std::string iniStr;
+            if (camDepthSensor->getIniParamsArrayForMode(mode, iniStr) ==
+                aditof::Status::OK) {
+                modeCaps->set_ini_array(iniStr);
+            } else {
+                complete = false;
+            }
+        }
+    }
+
+    if (camDepthSensor) {
+        std::vector<std::string> controls;
+        status = camDepthSensor->getAvailableControls(controls);
+        if (status != aditof::Status::OK) {
+            return status;
+        }
+        for (const auto &control : controls) {
+            caps.add_controls(control);
         }
-        } // switch
+    }
+    return aditof::Status::OK;
+}
+
+// Replies to GetSensorCapabilities from the kept capabilities, reading them
+// first when there are none. The depth compute parameters can be changed by
+// the client, so they are read every time.
+void SensorSession::describe_capabilities(payload::ServerResponse &buff_send) {
+    auto caps = buff_send.mutable_sensor_capabilities();
+    if (capabilities) {
+        ++capabilitiesCached;
+        caps->CopyFrom(*capabilities);
     } else {
+        bool complete = false;
+        aditof::Status status = build_capabilities(*caps, complete);
+        if (status != aditof::Status::OK) {
+            buff_send.clear_sensor_capabilities();
+            buff_send.set_status(static_cast<::payload::Status>(status));
+            return;
+        }
+        ++capabilitiesBuilt;
+        if (complete) {
+            capabilities.reset(new payload::SensorCapabilities(*caps));
+        }
+    }
+
+    std::map<std::string, std::string> params;
+    if (camDepthSensor &&
+        camDepthSensor->getDepthComputeParams(params) == aditof::Status::OK) {
+        for (const char *name : depthComputeParamNames) {
+            caps->add_depth_compute_params(params[name]);
+        }
+    }
+    buff_send.set_status(static_cast<::payload::Status>(aditof::Status::OK));
+}
+
+// Searches the sensors once and attaches each one to its session, adding
+// sessions for the sensors after the first. A replay is streamed by session
+// 0. Sessions in use or kept warm are left alone. The reply describes the
+// sensor the request is for and says how many there are.
+static void find_sensors(const payload::ClientRequest &buff_recv,
+                         payload::ServerResponse &buff_send) {
+    const size_t index = buff_recv.sensor_index();
+
+    if (replayEnabled) {
+        if (index > 0) {
+            buff_send.set_message("A replay has no sensor " +
+                                  std::to_string(index));
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::UNAVAILABLE));
+            return;
+        }
+        SensorSession &session = *sessions.front();
+        if (!session.clientEngagedWithSensors && !session.warm &&
+            !session.jobs.pending()) {
+            session.frameSource =
+                std::make_shared<ReplayFrameSource>(replayConfig);
+            session.capabilities.reset();
+        }
+
+        std::string name;
+        session.frameSource->getName(name);
+        buff_send.mutable_sensors_info()->mutable_image_sensors()->set_name(
+            name);
+        buff_send.mutable_card_image_version();
+        buff_send.set_sensor_count(1);
+
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::OK));
+        return;
+    }
+
+    if (!sensors_are_created) {
+#ifdef TARGET
+        sensorsEnumerator =
+            aditof::SensorEnumeratorFactory::buildTargetSensorEnumerator();
+#endif
+        if (!sensorsEnumerator) {
+            std::string errMsg = "Failed to create a target sensor enumerator";
+            LOG(WARNING) << errMsg;
+            buff_send.set_message(errMsg);
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::UNAVAILABLE));
+            return;
+        }
+
+        sensorsEnumerator->searchSensors();
+        sensorsEnumerator->getDepthSensors(depthSensors);
+        sensors_are_created = true;
+    }
+
+    /* Add information about available sensors */
+
+    // Depth sensor
+    if (depthSensors.size() < 1) {
+        buff_send.set_message("No depth sensors are available");
+        buff_send.set_status(::payload::Status::UNREACHABLE);
+        return;
+    }
+    buff_send.set_sensor_count(static_cast<uint32_t>(depthSensors.size()));
+    if (index >= depthSensors.size()) {
+        buff_send.set_message("No sensor " + std::to_string(index));
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::UNAVAILABLE));
+        return;
+    }
+
+    while (sessions.size() < depthSensors.size()) {
+        auto session = std::make_unique<SensorSession>(sessions.size());
+        std::lock_guard<std::mutex> lock(sessionsMutex);
+        sessions.push_back(std::move(session));
+    }
+    for (size_t i = 0; i < depthSensors.size(); ++i) {
+        if (!sessions[i]->clientEngagedWithSensors && !sessions[i]->warm &&
+            !sessions[i]->jobs.pending()) {
+            sessions[i]->attach_sensor(depthSensors[i]);
+        }
+    }
+
+    std::string name;
+    sessions[index]->camDepthSensor->getName(name);
+    auto pbSensorsInfo = buff_send.mutable_sensors_info();
+    auto pbDepthSensorInfo = pbSensorsInfo->mutable_image_sensors();
+    pbDepthSensorInfo->set_name(name);
+
+    fill_card_image_version(buff_send.mutable_card_image_version());
+
+    buff_send.set_status(static_cast<::payload::Status>(aditof::Status::OK));
+}
+
+// Requests about the whole server are answered here, the others by the
+// session of the sensor they are for
+void invoke_sdk_api(const payload::ClientRequest &buff_recv,
+                    payload::ServerResponse &buff_send) {
+    buff_send.set_server_status(::payload::ServerStatus::REQUEST_ACCEPTED);
+
+    DLOG(INFO) << buff_recv.func_name() << " function";
+
+    auto it = s_map_api_Values.find(buff_recv.func_name());
+    if (it == s_map_api_Values.end()) {
         LOG(ERROR) << "Unknown function name : " << buff_recv.func_name();
+        sessions.front()->set_interrupt_flag(buff_send);
+        return;
     }
 
-    {
-        if (adsd3500InterruptsQueueMutex.try_lock_for(
-                std::chrono::milliseconds(500))) {
-            buff_send.set_interrupt_occured(!adsd3500InterruptsQueue.empty());
-            adsd3500InterruptsQueueMutex.unlock();
+    if (it->second == FIND_SENSORS) {
+        find_sensors(buff_recv, buff_send);
+    } else if (it->second == SERVER_CONNECT) {
+        // Other clients can still watch the stream with Subscribe
+        if (!no_of_client_connected) {
+            buff_send.set_message("Connection Allowed");
+        } else if (maxSubscribers) {
+            buff_send.set_message("Only 1 client connection allowed, "
+                                  "others can subscribe");
         } else {
-            LOG(ERROR)
-                << "Unable to lock adsd3500InterruptsQueueMutex in 500 ms";
+            buff_send.set_message("Only 1 client connection allowed");
         }
     }
 
-    buff_recv.Clear();
+    const size_t index = buff_recv.sensor_index();
+    if (index >= sessions.size()) {
+        if (it->second != FIND_SENSORS) {
+            buff_send.set_message("No sensor " + std::to_string(index));
+            buff_send.set_status(
+                static_cast<::payload::Status>(aditof::Status::UNAVAILABLE));
+        }
+        return;
+    }
+    SensorSession &session = *sessions[index];
+
+    if (it->second == GET_SERVER_STATS) {
+        fill_server_stats(session, buff_send.mutable_server_stats());
+        buff_send.set_status(
+            static_cast<::payload::Status>(aditof::Status::OK));
+    } else if (it->second != FIND_SENSORS && it->second != SERVER_CONNECT) {
+        session.handle_request(it->second, buff_recv, buff_send);
+    }
+
+    session.set_interrupt_flag(buff_send);
 }
 
 void Initialize() {
@@ -1228,4 +3836,15 @@ void Initialize() {
     s_map_api_Values["GetIniArray"] = GET_INI_ARRAY;
     s_map_api_Values["ServerConnect"] = SERVER_CONNECT;
     s_map_api_Values["RecvAsync"] = RECV_ASYNC;
+    s_map_api_Values["SetFrameHeader"] = SET_FRAME_HEADER;
+    s_map_api_Values["GetServerStats"] = GET_SERVER_STATS;
+    s_map_api_Values["GrantFrameCredits"] = GRANT_FRAME_CREDITS;
+    s_map_api_Values["SetFrameContent"] = SET_FRAME_CONTENT;
+    s_map_api_Values["SetFrameRegion"] = SET_FRAME_REGION;
+    s_map_api_Values["RequestKeyframe"] = REQUEST_KEYFRAME;
+    s_map_api_Values["Subscribe"] = SUBSCRIBE;
+    s_map_api_Values["Unsubscribe"] = UNSUBSCRIBE;
+    s_map_api_Values["GetSensorCapabilities"] = GET_SENSOR_CAPABILITIES;
+    s_map_api_Values["Adsd3500Batch"] = ADSD3500_BATCH;
+    s_map_api_Values["GetJobStatus"] = GET_JOB_STATUS;
 }
@@ -65,7 +65,19 @@ enum api_Values {
     SET_DEPTH_COMPUTE_PARAM,
     GET_INI_ARRAY,
     SERVER_CONNECT,
-    RECV_ASYNC
+    RECV_ASYNC,
+    SET_FRAME_HEADER,
+    GET_SERVER_STATS,
+    GRANT_FRAME_CREDITS,
+    SET_FRAME_CONTENT,
+    SET_FRAME_REGION,
+    REQUEST_KEYFRAME,
+    SUBSCRIBE,
+    UNSUBSCRIBE,
+    GET_SENSOR_CAPABILITIES,
+    ADSD3500_BATCH,
+    GET_JOB_STATUS,
+    API_VALUES_COUNT // must stay last
 };
 
 enum protocols { PROTOCOL_EXAMPLE, PROTOCOL_COUNT };
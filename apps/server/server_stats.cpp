@@ -0,0 +1,60 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "server_stats.h"
+
+void add_stats_counter(payload::ServerStats *stats, const std::string &name,
+                       uint64_t value) {
+    auto counter = stats->add_counters();
+    counter->set_name(name);
+    counter->set_value(value);
+}
+
+void add_stats_histogram(payload::ServerStats *stats, const std::string &name,
+                         const LatencyHistogram &histogram) {
+    auto pbHistogram = stats->add_histograms();
+    pbHistogram->set_name(name);
+    pbHistogram->set_count(histogram.count());
+    pbHistogram->set_sum_us(histogram.sumUs());
+    pbHistogram->set_max_us(histogram.maxUs());
+    pbHistogram->set_p50_us(histogram.percentileUs(50));
+    pbHistogram->set_p90_us(histogram.percentileUs(90));
+    pbHistogram->set_p99_us(histogram.percentileUs(99));
+
+    for (size_t i = 0; i < LatencyHistogram::BUCKET_COUNT; ++i) {
+        uint64_t count = histogram.bucketCount(i);
+        if (count == 0) {
+            continue;
+        }
+        pbHistogram->add_bucket_upper_us(LatencyHistogram::bucketUpperUs(i));
+        pbHistogram->add_bucket_count(count);
+    }
+}
@@ -0,0 +1,278 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "shm_frame_ring.h"
+
+#include <climits>
+#include <cstring>
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <new>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <time.h>
+#include <unistd.h>
+
+namespace {
+
+const size_t SLOT_ALIGNMENT = 64;
+
+size_t align_up(size_t value) {
+    return (value + SLOT_ALIGNMENT - 1) / SLOT_ALIGNMENT * SLOT_ALIGNMENT;
+}
+
+// Shared futexes, since readers are other processes
+long futex_wait(const std::atomic<uint32_t> *word, uint32_t value,
+                const timespec *timeout) {
+    return syscall(SYS_futex, reinterpret_cast<const uint32_t *>(word),
+                   FUTEX_WAIT, value, timeout, nullptr, 0);
+}
+
+void futex_wake_all(std::atomic<uint32_t> *word) {
+    syscall(SYS_futex, reinterpret_cast<uint32_t *>(word), FUTEX_WAKE, INT_MAX,
+            nullptr, nullptr, 0);
+}
+
+} // namespace
+
+ShmFrameRing::~ShmFrameRing() { destroy(); }
+
+aditof::Status ShmFrameRing::create(const std::string &name, size_t slotCount,
+                                    size_t maxFrameSize) {
+    const size_t slotSize = align_up(sizeof(ShmSlotHeader) + maxFrameSize);
+    const size_t slotsOffset = align_up(sizeof(ShmRingHeader));
+    if (!slotCount || slotCount > UINT16_MAX) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    if (m_ring && name == m_name && m_ring->slotCount == slotCount &&
+        m_ring->slotSize == slotSize) {
+        return aditof::Status::OK;
+    }
+    destroy();
+
+    // A new segment, so that readers of an old one are not confused by its
+    // size changing under them
+    shm_unlink(name.c_str());
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0660);
+    if (fd < 0) {
+        return aditof::Status::GENERIC_ERROR;
+    }
+    const size_t mappedSize = slotsOffset + slotCount * slotSize;
+    void *mapped = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(mappedSize)) == 0) {
+        mapped = mmap(nullptr, mappedSize, PROT_READ | PROT_WRITE, MAP_SHARED,
+                      fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(name.c_str());
+        return aditof::Status::GENERIC_ERROR;
+    }
+
+    // The segment is zero filled: every slot sequence starts at 0
+    m_ring = new (mapped) ShmRingHeader();
+    m_ring->version = SHM_RING_VERSION;
+    m_ring->slotCount = static_cast<uint16_t>(slotCount);
+    m_ring->slotSize = slotSize;
+    m_ring->slotsOffset = slotsOffset;
+    m_ring->published.store(0);
+    m_ring->futex.store(0);
+    m_ring->closed.store(0);
+    for (size_t i = 0; i < slotCount; ++i) {
+        new (static_cast<uint8_t *>(mapped) + slotsOffset + i * slotSize)
+            ShmSlotHeader();
+    }
+    // Readers check the magic last
+    std::atomic_thread_fence(std::memory_order_release);
+    m_ring->magic = SHM_RING_MAGIC;
+
+    m_mappedSize = mappedSize;
+    m_maxFrameSize = slotSize - sizeof(ShmSlotHeader);
+    m_name = name;
+    return aditof::Status::OK;
+}
+
+void ShmFrameRing::destroy() {
+    if (!m_ring) {
+        return;
+    }
+    m_ring->closed.store(1, std::memory_order_release);
+    m_ring->futex.fetch_add(1, std::memory_order_release);
+    futex_wake_all(&m_ring->futex);
+    munmap(m_ring, m_mappedSize);
+    shm_unlink(m_name.c_str());
+    m_ring = nullptr;
+    m_mappedSize = 0;
+}
+
+bool ShmFrameRing::publish(const FrameHeader &header, const uint8_t *data,
+                           size_t size) {
+    if (!m_ring || size > m_maxFrameSize) {
+        return false;
+    }
+
+    const uint64_t index = m_ring->published.load(std::memory_order_relaxed);
+    uint8_t *base = reinterpret_cast<uint8_t *>(m_ring) + m_ring->slotsOffset +
+                    (index % m_ring->slotCount) * m_ring->slotSize;
+    ShmSlotHeader *slot = reinterpret_cast<ShmSlotHeader *>(base);
+
+    slot->sequence.store(2 * index + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    slot->size = size;
+    slot->header = header;
+    memcpy(base + sizeof(ShmSlotHeader), data, size);
+    slot->sequence.store(2 * index + 2, std::memory_order_release);
+
+    m_ring->published.store(index + 1, std::memory_order_release);
+    m_ring->futex.fetch_add(1, std::memory_order_release);
+    futex_wake_all(&m_ring->futex);
+    return true;
+}
+
+ShmFrameReader::~ShmFrameReader() { close(); }
+
+aditof::Status ShmFrameReader::open(const std::string &name) {
+    close();
+
+    int fd = shm_open(name.c_str(), O_RDONLY, 0);
+    if (fd < 0) {
+        return aditof::Status::UNAVAILABLE;
+    }
+    struct stat info;
+    void *mapped = MAP_FAILED;
+    if (fstat(fd, &info) == 0 &&
+        static_cast<size_t>(info.st_size) >= sizeof(ShmRingHeader)) {
+        mapped = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return aditof::Status::UNAVAILABLE;
+    }
+
+    const ShmRingHeader *ring = static_cast<const ShmRingHeader *>(mapped);
+    const size_t size = static_cast<size_t>(info.st_size);
+    if (ring->magic != SHM_RING_MAGIC || ring->version != SHM_RING_VERSION ||
+        ring->slotsOffset + ring->slotCount * ring->slotSize > size) {
+        munmap(mapped, size);
+        return aditof::Status::UNAVAILABLE;
+    }
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    m_ring = ring;
+    m_mappedSize = size;
+    m_next = ring->published.load(std::memory_order_acquire);
+    return aditof::Status::OK;
+}
+
+void ShmFrameReader::close() {
+    if (m_ring) {
+        munmap(const_cast<ShmRingHeader *>(m_ring), m_mappedSize);
+        m_ring = nullptr;
+    }
+}
+
+const ShmSlotHeader *ShmFrameReader::slot(uint64_t index) const {
+    return reinterpret_cast<const ShmSlotHeader *>(
+        reinterpret_cast<const uint8_t *>(m_ring) + m_ring->slotsOffset +
+        (index % m_ring->slotCount) * m_ring->slotSize);
+}
+
+aditof::Status ShmFrameReader::next(int timeoutMs, ShmFrame &frame) {
+    if (!m_ring) {
+        return aditof::Status::UNAVAILABLE;
+    }
+
+    timespec deadline;
+    clock_gettime(CLOCK_MONOTONIC, &deadline);
+    deadline.tv_sec += timeoutMs / 1000;
+    deadline.tv_nsec += (timeoutMs % 1000) * 1000000L;
+    if (deadline.tv_nsec >= 1000000000L) {
+        ++deadline.tv_sec;
+        deadline.tv_nsec -= 1000000000L;
+    }
+
+    frame.skipped = 0;
+    while (true) {
+        const uint32_t futex = m_ring->futex.load(std::memory_order_acquire);
+        if (m_ring->closed.load(std::memory_order_acquire)) {
+            return aditof::Status::UNAVAILABLE;
+        }
+
+        const uint64_t published =
+            m_ring->published.load(std::memory_order_acquire);
+        if (published > m_next) {
+            // Skip what the server already wrote over
+            if (published - m_next > m_ring->slotCount) {
+                frame.skipped += published - m_ring->slotCount - m_next;
+                m_next = published - m_ring->slotCount;
+            }
+            const ShmSlotHeader *s = slot(m_next);
+            if (s->sequence.load(std::memory_order_acquire) !=
+                2 * m_next + 2) {
+                ++frame.skipped;
+                ++m_next;
+                continue;
+            }
+            frame.header = s->header;
+            frame.size = s->size;
+            frame.data = reinterpret_cast<const uint8_t *>(s) +
+                         sizeof(ShmSlotHeader);
+            frame.index = m_next++;
+            if (frame.size > m_ring->slotSize - sizeof(ShmSlotHeader) ||
+                !isValid(frame)) {
+                ++frame.skipped;
+                continue;
+            }
+            return aditof::Status::OK;
+        }
+
+        timespec now;
+        clock_gettime(CLOCK_MONOTONIC, &now);
+        timespec left;
+        left.tv_sec = deadline.tv_sec - now.tv_sec;
+        left.tv_nsec = deadline.tv_nsec - now.tv_nsec;
+        if (left.tv_nsec < 0) {
+            --left.tv_sec;
+            left.tv_nsec += 1000000000L;
+        }
+        if (left.tv_sec < 0) {
+            return aditof::Status::BUSY;
+        }
+        futex_wait(&m_ring->futex, futex, &left);
+    }
+}
+
+bool ShmFrameReader::isValid(const ShmFrame &frame) const {
+    std::atomic_thread_fence(std::memory_order_acquire);
+    return slot(frame.index)->sequence.load(std::memory_order_relaxed) ==
+           2 * frame.index + 2;
+}
@@ -0,0 +1,159 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SHM_FRAME_RING_H
+#define SHM_FRAME_RING_H
+
+#include "frame_header.h"
+
+#include <aditof/status_definitions.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/**
+ * @brief Ring of frames in a POSIX shared memory segment, for consumers
+ * running on the same machine as the server.
+ *
+ * The server writes each frame with its FrameHeader in the next slot,
+ * overwriting the oldest one, and wakes the readers with a futex. Readers
+ * map the segment read-only and use frames in place. A slot is guarded by a
+ * sequence number (odd while it is written), so a reader can tell whether a
+ * frame was overwritten while it used it.
+ */
+struct ShmRingHeader {
+    uint32_t magic;                  // SHM_RING_MAGIC
+    uint16_t version;                // SHM_RING_VERSION
+    uint16_t slotCount;              // slots after this header
+    uint64_t slotSize;               // bytes per slot, ShmSlotHeader included
+    uint64_t slotsOffset;            // where the first slot starts
+    std::atomic<uint64_t> published; // frames written so far
+    std::atomic<uint32_t> futex;     // changes with every frame
+    std::atomic<uint32_t> closed;    // the server no longer writes
+};
+
+struct ShmSlotHeader {
+    std::atomic<uint64_t> sequence; // 2n + 1 while frame n is written, then
+                                    // 2n + 2
+    uint64_t size;                  // bytes of the frame after this header
+    FrameHeader header;
+};
+
+static_assert(ATOMIC_LLONG_LOCK_FREE == 2 && ATOMIC_INT_LOCK_FREE == 2,
+              "atomics in shared memory must be lock free");
+
+static const uint32_t SHM_RING_MAGIC = 0x52534441; // "ADSR"
+static const uint16_t SHM_RING_VERSION = 1;
+
+/**
+ * @brief Writing end of the ring, owned by the server.
+ */
+class ShmFrameRing {
+  public:
+    ~ShmFrameRing();
+
+    /**
+     * @brief Creates the segment called name (e.g. "/aditof-frames") with
+     * slotCount slots of up to maxFrameSize bytes. An existing ring of the
+     * same size is kept, otherwise readers of the previous one see it
+     * closed.
+     */
+    aditof::Status create(const std::string &name, size_t slotCount,
+                          size_t maxFrameSize);
+
+    /**
+     * @brief Closes and removes the segment.
+     */
+    void destroy();
+
+    bool isCreated() const { return m_ring != nullptr; }
+
+    /**
+     * @brief Writes a frame to the next slot and wakes the readers.
+     * @return false if the frame doesn't fit in a slot.
+     */
+    bool publish(const FrameHeader &header, const uint8_t *data, size_t size);
+
+  private:
+    ShmRingHeader *m_ring = nullptr;
+    size_t m_mappedSize = 0;
+    size_t m_maxFrameSize = 0;
+    std::string m_name;
+};
+
+/**
+ * @brief A frame of the ring, valid until it is overwritten.
+ */
+struct ShmFrame {
+    FrameHeader header;
+    const uint8_t *data = nullptr;
+    size_t size = 0;
+    uint64_t index = 0;   // frames published before this one
+    uint64_t skipped = 0; // frames overwritten before they could be read
+};
+
+/**
+ * @brief Reading end of the ring.
+ */
+class ShmFrameReader {
+  public:
+    ~ShmFrameReader();
+
+    /**
+     * @brief Maps the ring called name. Reading starts with the next frame
+     * written.
+     */
+    aditof::Status open(const std::string &name);
+    void close();
+
+    /**
+     * @brief Waits up to timeoutMs for the frame after the last one read.
+     * Frames that were overwritten are skipped. Returns UNAVAILABLE if the
+     * server closed the ring.
+     */
+    aditof::Status next(int timeoutMs, ShmFrame &frame);
+
+    /**
+     * @brief Whether frame is still in its slot. Checked after using it.
+     */
+    bool isValid(const ShmFrame &frame) const;
+
+  private:
+    const ShmSlotHeader *slot(uint64_t index) const;
+
+    const ShmRingHeader *m_ring = nullptr;
+    size_t m_mappedSize = 0;
+    uint64_t m_next = 0;
+};
+
+#endif // SHM_FRAME_RING_H
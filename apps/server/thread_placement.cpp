@@ -0,0 +1,134 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "thread_placement.h"
+
+#include <aditof/log.h>
+#include <cstdlib>
+#include <pthread.h>
+#include <sched.h>
+#include <thread>
+#include <zmq.h>
+
+bool parseThreadPlacement(const std::string &text, ThreadPlacement &placement) {
+    placement = ThreadPlacement();
+    if (text.empty()) {
+        return true;
+    }
+
+    char *end = nullptr;
+    long cpu = std::strtol(text.c_str(), &end, 10);
+    if (end == text.c_str() || cpu < 0 || cpu >= CPU_SETSIZE) {
+        return false;
+    }
+    long priority = 0;
+    if (*end == ':') {
+        const char *start = end + 1;
+        priority = std::strtol(start, &end, 10);
+        if (end == start || priority < 1 || priority > 99) {
+            return false;
+        }
+    }
+    if (*end != '\0') {
+        return false;
+    }
+
+    placement.cpu = static_cast<int>(cpu);
+    placement.priority = static_cast<int>(priority);
+    return true;
+}
+
+aditof::Status placeCurrentThread(const ThreadPlacement &placement,
+                                  const char *name) {
+    pthread_t self = pthread_self();
+    // Names are limited to 15 characters
+    pthread_setname_np(self, std::string(name).substr(0, 15).c_str());
+
+    aditof::Status status = aditof::Status::OK;
+    if (placement.cpu >= 0) {
+        cpu_set_t cpus;
+        CPU_ZERO(&cpus);
+        CPU_SET(placement.cpu, &cpus);
+        if (pthread_setaffinity_np(self, sizeof(cpus), &cpus) != 0) {
+            LOG(WARNING) << "Unable to pin " << name << " to CPU "
+                         << placement.cpu;
+            status = aditof::Status::INVALID_ARGUMENT;
+        }
+    }
+    if (placement.priority > 0) {
+        sched_param param = {};
+        param.sched_priority = placement.priority;
+        if (pthread_setschedparam(self, SCHED_FIFO, &param) != 0) {
+            LOG(WARNING) << "Unable to run " << name
+                         << " with SCHED_FIFO priority "
+                         << placement.priority
+                         << ", continuing with the default policy";
+            status = aditof::Status::UNAVAILABLE;
+        }
+    }
+    return status;
+}
+
+aditof::Status placeZmqIoThreads(void *context,
+                                 const ThreadPlacement &placement) {
+    aditof::Status status = aditof::Status::OK;
+    if (placement.cpu >= 0 &&
+        zmq_ctx_set(context, ZMQ_THREAD_AFFINITY_CPU_ADD, placement.cpu) !=
+            0) {
+        LOG(WARNING) << "Unable to pin the ZMQ I/O thread to CPU "
+                     << placement.cpu;
+        status = aditof::Status::INVALID_ARGUMENT;
+    }
+    if (placement.priority <= 0) {
+        return status;
+    }
+
+    // ZMQ asserts when it can't apply the policy to the thread it starts, so
+    // the priority is first tried on a thread of ours
+    bool permitted = false;
+    std::thread probe([&placement, &permitted] {
+        sched_param param = {};
+        param.sched_priority = placement.priority;
+        permitted =
+            pthread_setschedparam(pthread_self(), SCHED_FIFO, &param) == 0;
+    });
+    probe.join();
+    if (!permitted ||
+        zmq_ctx_set(context, ZMQ_THREAD_SCHED_POLICY, SCHED_FIFO) != 0 ||
+        zmq_ctx_set(context, ZMQ_THREAD_PRIORITY, placement.priority) != 0) {
+        LOG(WARNING) << "Unable to run the ZMQ I/O thread with SCHED_FIFO "
+                        "priority "
+                     << placement.priority
+                     << ", continuing with the default policy";
+        status = aditof::Status::UNAVAILABLE;
+    }
+    return status;
+}
@@ -0,0 +1,68 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef THREAD_PLACEMENT_H
+#define THREAD_PLACEMENT_H
+
+#include <aditof/status_definitions.h>
+
+#include <string>
+
+/**
+ * @brief CPU and real-time priority of the thread of a pipeline stage.
+ */
+struct ThreadPlacement {
+    int cpu = -1;     // CPU the thread is pinned to, -1 for any
+    int priority = 0; // SCHED_FIFO priority (1 to 99), 0 for SCHED_OTHER
+};
+
+/**
+ * @brief Parses "<cpu>[:<priority>]". An empty text is the default
+ * placement.
+ */
+bool parseThreadPlacement(const std::string &text, ThreadPlacement &placement);
+
+/**
+ * @brief Names the calling thread and applies placement to it. Failing to
+ * get the priority (no CAP_SYS_NICE) is logged, the thread then runs with
+ * the default policy.
+ */
+aditof::Status placeCurrentThread(const ThreadPlacement &placement,
+                                  const char *name);
+
+/**
+ * @brief Applies placement to the I/O threads of a ZMQ context. Must be
+ * called before the context has any socket.
+ */
+aditof::Status placeZmqIoThreads(void *context,
+                                 const ThreadPlacement &placement);
+
+#endif // THREAD_PLACEMENT_H
@@ -0,0 +1,372 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "tile_delta.h"
+#include "frame_header.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint16_t DEFAULT_TILE_SIZE = 32;
+const uint32_t DEFAULT_KEYFRAME_INTERVAL = 30;
+
+size_t bitmap_bytes(size_t tiles) { return (tiles + 31) / 32 * 4; }
+
+// Written without early exit so that it vectorizes
+bool row_differs(const uint16_t *a, const uint16_t *b, size_t count,
+                 uint16_t threshold) {
+    uint16_t largest = 0;
+    for (size_t i = 0; i < count; ++i) {
+        uint16_t diff = a[i] > b[i] ? a[i] - b[i] : b[i] - a[i];
+        largest = std::max(largest, diff);
+    }
+    return largest > threshold;
+}
+
+// Calls fn(offset, bytes) for each row of a tile of a plane
+template <typename Fn>
+void for_each_tile_row(size_t planeOffset, size_t pixelSize, size_t width,
+                       size_t height, size_t tileSize, size_t tile,
+                       size_t tilesX, Fn fn) {
+    const size_t x0 = tile % tilesX * tileSize;
+    const size_t y0 = tile / tilesX * tileSize;
+    const size_t w = std::min(tileSize, width - x0);
+    const size_t h = std::min(tileSize, height - y0);
+    for (size_t y = y0; y < y0 + h; ++y) {
+        fn(planeOffset + (y * width + x0) * pixelSize, w * pixelSize);
+    }
+}
+
+} // namespace
+
+void TileDeltaEncoder::addRun(size_t offset, size_t bytes) {
+    TileDeltaRun run;
+    run.offset = static_cast<uint32_t>(offset);
+    run.bytes = static_cast<uint32_t>(bytes);
+    m_runs.push_back(run);
+}
+
+aditof::Status TileDeltaEncoder::configure(uint16_t layout, uint16_t width,
+                                           uint16_t height,
+                                           uint16_t planeCount,
+                                           size_t frameSize, uint16_t tileSize,
+                                           uint16_t threshold,
+                                           uint32_t keyframeInterval) {
+    m_planes.clear();
+    m_runs.clear();
+    m_changed.clear();
+    m_reference.clear();
+    m_frameSize = 0;
+    m_maxEncodedSize = 0;
+
+    tileSize = tileSize ? tileSize : DEFAULT_TILE_SIZE;
+    const size_t plane = static_cast<size_t>(width) * height;
+    if (tileSize < 4 || tileSize > 256 || plane * 2 < FRAME_METADATA_SIZE ||
+        frameSize > UINT32_MAX) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    // The planes in payload order, see FrameContent
+    uint16_t content = 0;
+    if (layout & FRAME_LAYOUT_SELECTED) {
+        content = layout & (FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+                            FRAME_CONTENT_CONF | FRAME_CONTENT_METADATA);
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+        content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB | FRAME_CONTENT_CONF;
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB) {
+        content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB;
+    }
+
+    size_t offset = 0;
+    if (layout == FRAME_LAYOUT_PCM) {
+        for (size_t p = 0; p < planeCount; ++p) {
+            m_planes.push_back({offset, 2, 0, true});
+            offset += plane * 2;
+        }
+    }
+    if (content & FRAME_CONTENT_DEPTH) {
+        m_planes.push_back({offset, 2, 0, true});
+        offset += plane * 2;
+    }
+    if (content & FRAME_CONTENT_AB) {
+        m_planes.push_back(
+            {offset, 2, FRAME_METADATA_SIZE / sizeof(uint16_t), true});
+        addRun(offset, FRAME_METADATA_SIZE);
+        offset += plane * 2;
+    }
+    if (content & FRAME_CONTENT_CONF) {
+        // Confidence follows the other planes unless it is alone
+        m_planes.push_back({offset, 4, 0, m_planes.empty()});
+        offset += plane * 4;
+    }
+    if (content & FRAME_CONTENT_METADATA) {
+        addRun(offset, FRAME_METADATA_SIZE);
+        offset += FRAME_METADATA_SIZE;
+    }
+    if (m_planes.empty() || m_planes.size() > UINT8_MAX ||
+        offset != frameSize) {
+        m_planes.clear();
+        m_runs.clear();
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    m_width = width;
+    m_height = height;
+    m_tileSize = tileSize;
+    m_threshold = threshold;
+    m_tilesX = (width + tileSize - 1) / tileSize;
+    m_tilesY = (height + tileSize - 1) / tileSize;
+    m_keyframeInterval =
+        keyframeInterval ? keyframeInterval : DEFAULT_KEYFRAME_INTERVAL;
+    m_changed.assign(m_tilesX * m_tilesY, 0);
+    m_reference.assign(frameSize, 0);
+    m_keyframeRequested = true;
+
+    size_t runBytes = 0;
+    for (const auto &run : m_runs) {
+        runBytes += run.bytes;
+    }
+    m_frameSize = frameSize;
+    m_maxEncodedSize = sizeof(TileDeltaHeader) +
+                       m_planes.size() * sizeof(TileDeltaPlane) +
+                       m_runs.size() * sizeof(TileDeltaRun) +
+                       bitmap_bytes(m_changed.size()) + frameSize + runBytes;
+    return aditof::Status::OK;
+}
+
+bool TileDeltaEncoder::begin() {
+    m_keyframe = m_keyframeRequested.exchange(false) ||
+                 m_sinceKeyframe + 1 >= m_keyframeInterval;
+    std::fill(m_changed.begin(), m_changed.end(), m_keyframe ? 1 : 0);
+    return m_keyframe;
+}
+
+void TileDeltaEncoder::compareTileRow(const uint8_t *frame, size_t row) {
+    for (size_t tile = row * m_tilesX; tile < (row + 1) * m_tilesX; ++tile) {
+        bool changed = false;
+        for (const Plane &plane : m_planes) {
+            if (!plane.compared || changed) {
+                continue;
+            }
+            for_each_tile_row(
+                plane.offset, plane.pixelSize, m_width, m_height, m_tileSize,
+                tile, m_tilesX, [&](size_t offset, size_t bytes) {
+                    // Leave out the pixels holding the metadata
+                    const size_t first = plane.offset +
+                                         plane.skip * plane.pixelSize;
+                    if (changed || offset + bytes <= first) {
+                        return;
+                    }
+                    if (offset < first) {
+                        bytes -= first - offset;
+                        offset = first;
+                    }
+                    if (plane.pixelSize == 2) {
+                        changed = row_differs(
+                            reinterpret_cast<const uint16_t *>(frame + offset),
+                            reinterpret_cast<const uint16_t *>(
+                                m_reference.data() + offset),
+                            bytes / 2, m_threshold);
+                    } else {
+                        changed = memcmp(frame + offset,
+                                         m_reference.data() + offset, bytes);
+                    }
+                });
+        }
+        m_changed[tile] = changed;
+    }
+}
+
+size_t TileDeltaEncoder::finish(const uint8_t *frame, uint8_t *out) {
+    uint8_t *dst = out + sizeof(TileDeltaHeader);
+    for (const Plane &plane : m_planes) {
+        TileDeltaPlane entry = {};
+        entry.offset = static_cast<uint32_t>(plane.offset);
+        entry.pixelSize = static_cast<uint16_t>(plane.pixelSize);
+        memcpy(dst, &entry, sizeof(entry));
+        dst += sizeof(entry);
+    }
+    for (const auto &run : m_runs) {
+        memcpy(dst, &run, sizeof(run));
+        dst += sizeof(run);
+    }
+
+    uint8_t *bitmap = dst;
+    memset(bitmap, 0, bitmap_bytes(m_changed.size()));
+    dst += bitmap_bytes(m_changed.size());
+    m_changedTiles = 0;
+    for (size_t tile = 0; tile < m_changed.size(); ++tile) {
+        if (!m_changed[tile]) {
+            continue;
+        }
+        bitmap[tile / 8] |= static_cast<uint8_t>(1u << (tile % 8));
+        ++m_changedTiles;
+        for (const Plane &plane : m_planes) {
+            for_each_tile_row(plane.offset, plane.pixelSize, m_width, m_height,
+                              m_tileSize, tile, m_tilesX,
+                              [&](size_t offset, size_t bytes) {
+                                  memcpy(dst, frame + offset, bytes);
+                                  memcpy(m_reference.data() + offset,
+                                         frame + offset, bytes);
+                                  dst += bytes;
+                              });
+        }
+    }
+    for (const auto &run : m_runs) {
+        memcpy(dst, frame + run.offset, run.bytes);
+        dst += run.bytes;
+    }
+
+    TileDeltaHeader header = {};
+    header.magic = TILE_DELTA_MAGIC;
+    header.version = TILE_DELTA_VERSION;
+    header.flags = m_keyframe ? TILE_DELTA_KEYFRAME : 0;
+    header.rawSize = static_cast<uint32_t>(m_frameSize);
+    header.encodedSize = static_cast<uint32_t>(dst - out);
+    header.width = m_width;
+    header.height = m_height;
+    header.tileSize = m_tileSize;
+    header.planeCount = static_cast<uint8_t>(m_planes.size());
+    header.runCount = static_cast<uint8_t>(m_runs.size());
+    header.changedTiles = static_cast<uint32_t>(m_changedTiles);
+    memcpy(out, &header, sizeof(header));
+
+    m_sinceKeyframe = m_keyframe ? 0 : m_sinceKeyframe + 1;
+    return header.encodedSize;
+}
+
+void TileDeltaDecoder::reset() {
+    m_frame.clear();
+    m_width = 0;
+    m_height = 0;
+    m_tileSize = 0;
+}
+
+aditof::Status TileDeltaDecoder::decode(const uint8_t *data, size_t size) {
+    TileDeltaHeader header;
+    if (size < sizeof(header)) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    memcpy(&header, data, sizeof(header));
+    if (header.magic != TILE_DELTA_MAGIC ||
+        header.version != TILE_DELTA_VERSION || header.encodedSize != size ||
+        !header.width || !header.height || !header.tileSize) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    const bool keyframe = header.flags & TILE_DELTA_KEYFRAME;
+    if (!keyframe &&
+        (m_frame.size() != header.rawSize || m_width != header.width ||
+         m_height != header.height || m_tileSize != header.tileSize)) {
+        // Nothing to apply the tiles to
+        return aditof::Status::UNAVAILABLE;
+    }
+
+    const size_t tilesX =
+        (header.width + header.tileSize - 1) / header.tileSize;
+    const size_t tilesY =
+        (header.height + header.tileSize - 1) / header.tileSize;
+    const size_t plane = static_cast<size_t>(header.width) * header.height;
+    const size_t tablesEnd = sizeof(header) +
+                             header.planeCount * sizeof(TileDeltaPlane) +
+                             header.runCount * sizeof(TileDeltaRun);
+    if (tablesEnd + bitmap_bytes(tilesX * tilesY) > size) {
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+
+    std::vector<TileDeltaPlane> planes(header.planeCount);
+    std::vector<TileDeltaRun> runs(header.runCount);
+    const uint8_t *table = data + sizeof(header);
+    for (auto &p : planes) {
+        memcpy(&p, table, sizeof(p));
+        table += sizeof(p);
+    }
+    for (auto &run : runs) {
+        memcpy(&run, table, sizeof(run));
+        table += sizeof(run);
+    }
+    for (const auto &p : planes) {
+        if ((p.pixelSize != 2 && p.pixelSize != 4) ||
+            p.offset + plane * p.pixelSize > header.rawSize) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+    }
+    for (const auto &run : runs) {
+        if (static_cast<size_t>(run.offset) + run.bytes > header.rawSize) {
+            return aditof::Status::INVALID_ARGUMENT;
+        }
+    }
+
+    if (keyframe) {
+        m_frame.assign(header.rawSize, 0);
+        m_width = header.width;
+        m_height = header.height;
+        m_tileSize = header.tileSize;
+    }
+
+    const uint8_t *bitmap = data + tablesEnd;
+    const uint8_t *src = bitmap + bitmap_bytes(tilesX * tilesY);
+    const uint8_t *end = data + size;
+    bool truncated = false;
+    for (size_t tile = 0; tile < tilesX * tilesY && !truncated; ++tile) {
+        if (!(bitmap[tile / 8] & (1u << (tile % 8)))) {
+            continue;
+        }
+        for (const auto &p : planes) {
+            for_each_tile_row(p.offset, p.pixelSize, header.width,
+                              header.height, header.tileSize, tile, tilesX,
+                              [&](size_t offset, size_t bytes) {
+                                  if (truncated ||
+                                      bytes > static_cast<size_t>(end - src)) {
+                                      truncated = true;
+                                      return;
+                                  }
+                                  memcpy(m_frame.data() + offset, src, bytes);
+                                  src += bytes;
+                              });
+        }
+    }
+    for (const auto &run : runs) {
+        if (truncated || run.bytes > static_cast<size_t>(end - src)) {
+            truncated = true;
+            break;
+        }
+        memcpy(m_frame.data() + run.offset, src, run.bytes);
+        src += run.bytes;
+    }
+    if (truncated) {
+        reset();
+        return aditof::Status::INVALID_ARGUMENT;
+    }
+    return aditof::Status::OK;
+}
@@ -0,0 +1,196 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef TILE_DELTA_H
+#define TILE_DELTA_H
+
+#include <aditof/status_definitions.h>
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @brief Streaming of the tiles that changed since the last frame sent.
+ *
+ * The image is cut in square tiles. A tile is sent when a 16-bit value of
+ * one of its planes is more than a threshold away from the value the client
+ * already has, and with it the tile of every other plane. Keyframes carry
+ * every tile. Runs of bytes that are not pixels, like the metadata, are sent
+ * with every frame.
+ *
+ * An encoded frame is a TileDeltaHeader, a TileDeltaPlane per plane, a
+ * TileDeltaRun per run, a bitmap of the tiles sent (one bit per tile in row
+ * order, padded to 4 bytes), the tiles of each plane in that order and the
+ * runs. All fields are little-endian.
+ */
+struct TileDeltaHeader {
+    uint32_t magic;        // TILE_DELTA_MAGIC
+    uint16_t version;      // TILE_DELTA_VERSION
+    uint16_t flags;        // TILE_DELTA_KEYFRAME
+    uint32_t rawSize;      // bytes of the reassembled frame
+    uint32_t encodedSize;  // bytes of the encoded frame, this header included
+    uint16_t width;        // pixels per row of every plane
+    uint16_t height;       // rows of every plane
+    uint16_t tileSize;     // side of a tile in pixels
+    uint8_t planeCount;    // TileDeltaPlane entries that follow
+    uint8_t runCount;      // TileDeltaRun entries after the planes
+    uint32_t changedTiles; // tiles in this frame
+    uint32_t reserved;
+};
+
+struct TileDeltaPlane {
+    uint32_t offset;    // where the plane starts in the frame
+    uint16_t pixelSize; // 2 or 4 bytes
+    uint16_t reserved;
+};
+
+struct TileDeltaRun {
+    uint32_t offset; // where the run starts in the frame
+    uint32_t bytes;
+};
+
+static_assert(sizeof(TileDeltaHeader) == 32, "TileDeltaHeader is part of the "
+                                             "wire protocol");
+static_assert(sizeof(TileDeltaPlane) == 8, "TileDeltaPlane is part of the "
+                                           "wire protocol");
+static_assert(sizeof(TileDeltaRun) == 8, "TileDeltaRun is part of the wire "
+                                         "protocol");
+
+static const uint32_t TILE_DELTA_MAGIC = 0x44544441; // "ADTD"
+static const uint16_t TILE_DELTA_VERSION = 1;
+static const uint16_t TILE_DELTA_KEYFRAME = 0x1;
+
+/**
+ * @brief Encodes frames against what the client was last sent.
+ */
+class TileDeltaEncoder {
+  public:
+    /**
+     * @brief Prepares encoding frames of frameSize bytes laid out as given
+     * (FrameLayout). Every keyframeInterval frames is a keyframe.
+     */
+    aditof::Status configure(uint16_t layout, uint16_t width, uint16_t height,
+                             uint16_t planeCount, size_t frameSize,
+                             uint16_t tileSize, uint16_t threshold,
+                             uint32_t keyframeInterval);
+
+    size_t frameSize() const { return m_frameSize; }
+    size_t maxEncodedSize() const { return m_maxEncodedSize; }
+    size_t tileCount() const { return m_changed.size(); }
+    size_t tileRowCount() const { return m_tilesY; }
+
+    /**
+     * @brief Makes the next frame a keyframe, e.g. when the client may have
+     * missed a frame. Can be called from any thread.
+     */
+    void requestKeyframe() { m_keyframeRequested = true; }
+
+    /**
+     * @brief Starts encoding a frame.
+     * @return Whether it is a keyframe, in which case no tile is compared.
+     */
+    bool begin();
+
+    /**
+     * @brief Finds the tiles of row that changed. Different rows can be
+     * compared at the same time by different threads.
+     */
+    void compareTileRow(const uint8_t *frame, size_t row);
+
+    /**
+     * @brief Writes the encoded frame to out, which has room for
+     * maxEncodedSize() bytes, and remembers what was sent.
+     * @return The size of the encoded frame.
+     */
+    size_t finish(const uint8_t *frame, uint8_t *out);
+
+    /**
+     * @brief Tiles of the last encoded frame.
+     */
+    size_t changedTiles() const { return m_changedTiles; }
+
+  private:
+    struct Plane {
+        size_t offset;
+        size_t pixelSize;
+        size_t skip;   // leading pixels that are not compared (metadata)
+        bool compared; // decides whether a tile changed
+    };
+
+    void addRun(size_t offset, size_t bytes);
+
+    std::vector<Plane> m_planes;
+    std::vector<TileDeltaRun> m_runs;
+    std::vector<uint8_t> m_reference; // what the client has
+    std::vector<uint8_t> m_changed;   // one per tile
+    std::atomic<bool> m_keyframeRequested{true};
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+    uint16_t m_tileSize = 0;
+    uint16_t m_threshold = 0;
+    size_t m_tilesX = 0;
+    size_t m_tilesY = 0;
+    uint32_t m_keyframeInterval = 0;
+    uint32_t m_sinceKeyframe = 0;
+    bool m_keyframe = false;
+    size_t m_changedTiles = 0;
+    size_t m_frameSize = 0;
+    size_t m_maxEncodedSize = 0;
+};
+
+/**
+ * @brief Reassembles the frames of a TileDeltaEncoder on the client.
+ */
+class TileDeltaDecoder {
+  public:
+    /**
+     * @brief Applies an encoded frame to the frame reassembled so far. Fails
+     * until a keyframe is received.
+     */
+    aditof::Status decode(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Forgets the frame, e.g. on a new Start.
+     */
+    void reset();
+
+    const std::vector<uint8_t> &frame() const { return m_frame; }
+
+  private:
+    std::vector<uint8_t> m_frame;
+    uint16_t m_width = 0;
+    uint16_t m_height = 0;
+    uint16_t m_tileSize = 0;
+};
+
+#endif // TILE_DELTA_H
@@ -0,0 +1,1236 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "buffer.pb.h"
+#include "frame_codec.h"
+#include "frame_header.h"
+#include "frame_pack.h"
+#ifdef WITH_SHM_TRANSPORT
+#include "shm_frame_ring.h"
+#endif
+#include "tile_delta.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <command_parser.h>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <zmq.hpp>
+
+static const char Help_Menu[] =
+    R"(aditof-server-benchmark usage:
+    aditof-server-benchmark
+    aditof-server-benchmark (-h | --help)
+    aditof-server-benchmark [-ip | --ip <address>] [-se | --sensor <index>]
+                            [-m | --mode <mode>]
+                            [-s | --stream <sync|async|credit|all>]
+                            [-c | --credits <count>]
+                            [-n | --frames <count>] [-w | --warmup <count>]
+                            [-ct | --content <planes>]
+                            [-rg | --region <x,y,width,height>]
+                            [-d | --decimate <factor>]
+                            [-pl | --pooling <sample|min|median>]
+                            [-nh | --no-header] [-z | --compress]
+                            [-p | --pack <planes>]
+                            [-td | --tile-delta] [-ts | --tile-size <pixels>]
+                            [-tt | --tile-threshold <value>]
+                            [-ki | --keyframe-interval <frames>]
+                            [-tr | --transport <tcp|shm>]
+                            [-sb | --subscribe] [-qd | --queue-depth <frames>]
+                            [-dp | --drop-policy <oldest|newest>]
+                            [-t | --timeout <ms>]
+                            [-j | --json <file>] [-rc | --record <file>]
+                            [-rs | --register-script <file>]
+
+    Options:
+      -h --help                 Show this screen.
+      -ip --ip <address>        Address of the server. [default: 127.0.0.1]
+      -se --sensor <index>      Sensor to stream when the server has
+                                several. [default: 0]
+      -m --mode <mode>          Mode to stream. [default: 0]
+      -s --stream <type>        Streaming to measure: sync (one GetFrame per
+                                frame), async (RecvAsync), credit
+                                (GrantFrameCredits) or all. [default: all]
+      -c --credits <count>      Frames the client lets the server have in
+                                flight in credit runs. [default: 8]
+      -n --frames <count>       Frames measured in each run. [default: 300]
+      -w --warmup <count>       Frames received before measuring. [default: 10]
+      -nh --no-header           Don't ask for the frame header. Latency then
+                                can't be measured in async runs.
+      -ct --content <planes>    Planes to receive, separated by commas:
+                                depth, ab, conf and metadata. All of them
+                                by default.
+      -rg --region <x,y,width,height>
+                                Part of the image to receive. Whole images
+                                by default.
+      -d --decimate <factor>    Keep one pixel in factor x factor of the
+                                region. [default: 1]
+      -pl --pooling <type>      How decimated depth pixels are made: sample,
+                                min or median. [default: sample]
+      -z --compress             Ask the server to compress frames. They are
+                                decoded as they are received.
+      -p --pack <planes>        Ask the server to send these planes 12-bit
+                                packed (depth, ab) when not compressing.
+                                They are unpacked as they are received.
+      -td --tile-delta          Ask the server to only send the tiles that
+                                changed when not compressing. Frames are
+                                reassembled as they are received.
+      -ts --tile-size <pixels>  Side of the tiles, 0 for the server default.
+                                [default: 0]
+      -tt --tile-threshold <value>
+                                Largest change of a depth or AB value the
+                                server doesn't send. [default: 0]
+      -ki --keyframe-interval <frames>
+                                Frames from one keyframe to the next, 0 for
+                                the server default. [default: 0]
+      -tr --transport <type>    Receive frames on port 5555 (tcp) or from the
+                                shared memory ring of a server on the same
+                                machine (shm). [default: tcp]
+      -sb --subscribe           Watch the stream another client is running
+                                instead of operating the camera. Needs a
+                                server started with --fan-out. --content
+                                and --region apply to the subscription.
+      -qd --queue-depth <frames>
+                                Frames the server queues for the subscriber.
+                                [default: 2]
+      -dp --drop-policy <policy>
+                                Frame the server drops when that queue is
+                                full: oldest or newest. [default: oldest]
+      -t --timeout <ms>         Time to wait for a reply or a frame.
+                                [default: 3000]
+      -j --json <file>          Write the results as JSON to <file>, - for
+                                the standard output.
+      -rc --record <file>       Save the measured frames to <file>, which the
+                                server can stream back with --replay.
+      -rs --register-script <file>
+                                Instead of streaming, apply the register
+                                commands of <file> once with a request per
+                                command and once with Adsd3500Batch.
+)";
+
+namespace {
+
+struct Options {
+    std::string ip;
+    uint32_t sensor = 0;
+    int mode = 0;
+    std::vector<std::string> streams;
+    int frames = 0;
+    int warmup = 0;
+    bool header = true;
+    bool compress = false;
+    std::vector<std::string> packedPlanes;
+    bool tileDelta = false;
+    uint32_t tileSize = 0;
+    uint32_t tileThreshold = 0;
+    uint32_t keyframeInterval = 0;
+    std::vector<std::string> content;
+    std::vector<int32_t> region; // x, y, width, height, decimation, pooling
+    std::string transport;
+    bool subscribe = false;
+    int queueDepth = 0;
+    int dropPolicy = 0; // 0 oldest, 1 newest
+    int timeoutMs = 0;
+    int credits = 0;
+    std::string jsonPath;
+    std::string recordPath;
+    std::string scriptPath;
+};
+
+// Distribution of a set of samples, in microseconds
+struct Summary {
+    size_t count = 0;
+    double min = 0;
+    double mean = 0;
+    double stddev = 0;
+    double p50 = 0;
+    double p90 = 0;
+    double p99 = 0;
+    double max = 0;
+};
+
+struct RunResult {
+    std::string stream;
+    bool ok = false;
+    std::string error;
+    uint64_t frames = 0;
+    uint64_t bytes = 0;    // received, headers included
+    uint64_t rawBytes = 0; // frames once decoded
+    uint16_t encoding = FRAME_ENCODING_RAW; // FrameEncoding
+    double seconds = 0;
+    uint64_t sequenceGaps = 0; // frames dropped by the server socket
+    uint64_t captureGaps = 0;  // frames dropped before being sent
+    uint64_t creditGrants = 0;
+    std::string transport;
+    uint64_t overwritten = 0; // shared memory frames overwritten while in use
+    std::vector<double> intervalsUs;
+    std::vector<double> captureLatencyUs; // capture -> received
+    std::vector<double> sendLatencyUs;    // handed to the socket -> received
+    std::vector<double> requestLatencyUs; // GetFrame sent -> frame received
+    std::vector<double> decodeUs;
+};
+
+// Time to apply a register script with a request per command and with a
+// single Adsd3500Batch request
+struct ScriptResult {
+    bool ok = false;
+    std::string error;
+    size_t commands = 0;
+    double singleMs = 0;
+    double batchMs = 0;
+};
+
+int64_t wall_clock_ns() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+Summary summarize(std::vector<double> samples) {
+    Summary s;
+    if (samples.empty()) {
+        return s;
+    }
+    std::sort(samples.begin(), samples.end());
+    s.count = samples.size();
+    s.min = samples.front();
+    s.max = samples.back();
+
+    double sum = 0;
+    for (double v : samples) {
+        sum += v;
+    }
+    s.mean = sum / s.count;
+    double squares = 0;
+    for (double v : samples) {
+        squares += (v - s.mean) * (v - s.mean);
+    }
+    s.stddev = std::sqrt(squares / s.count);
+
+    auto percentile = [&samples](double p) {
+        size_t rank = static_cast<size_t>(std::ceil(p * samples.size()));
+        return samples[std::min(samples.size() - 1, rank ? rank - 1 : 0)];
+    };
+    s.p50 = percentile(0.50);
+    s.p90 = percentile(0.90);
+    s.p99 = percentile(0.99);
+    return s;
+}
+
+// Connection to the control port of the server
+// A frame as received, with its header if the server sent one
+struct ReceivedFrame {
+    FrameHeader header = {};
+    bool hasHeader = false;
+    const uint8_t *payload = nullptr; // valid until the next frame
+    size_t payloadSize = 0;
+    size_t bytes = 0; // received, header included
+};
+
+class FrameReceiver {
+  public:
+    virtual ~FrameReceiver() = default;
+    virtual bool receive(ReceivedFrame &frame, std::string &error) = 0;
+
+    // Whether the last frame was left alone while it was used
+    virtual bool isStillValid() const { return true; }
+};
+
+// Frames pushed on port 5555
+class ZmqReceiver : public FrameReceiver {
+  public:
+    ZmqReceiver(zmq::context_t &context, const std::string &address,
+                int timeoutMs)
+        : m_socket(context, zmq::socket_type::pull) {
+        m_socket.set(zmq::sockopt::rcvtimeo, timeoutMs);
+        m_socket.set(zmq::sockopt::linger, 0);
+        m_socket.connect(address);
+    }
+
+    bool receive(ReceivedFrame &frame, std::string &error) override {
+        if (!m_socket.recv(m_part, zmq::recv_flags::none)) {
+            error = "timeout";
+            return false;
+        }
+
+        frame = ReceivedFrame();
+        frame.bytes = m_part.size();
+        if (m_part.more()) {
+            if (m_part.size() >= sizeof(FrameHeader)) {
+                memcpy(&frame.header, m_part.data(), sizeof(FrameHeader));
+                frame.hasHeader = frame.header.magic == FRAME_HEADER_MAGIC;
+            }
+            if (!m_socket.recv(m_part, zmq::recv_flags::none)) {
+                error = "incomplete frame";
+                return false;
+            }
+            frame.bytes += m_part.size();
+            while (m_part.more()) {
+                m_socket.recv(m_part, zmq::recv_flags::none);
+            }
+        }
+        frame.payload = static_cast<const uint8_t *>(m_part.data());
+        frame.payloadSize = m_part.size();
+        return true;
+    }
+
+  private:
+    zmq::socket_t m_socket;
+    zmq::message_t m_part;
+};
+
+#ifdef WITH_SHM_TRANSPORT
+// Frames read in place from the shared memory ring of the server
+class ShmReceiver : public FrameReceiver {
+  public:
+    explicit ShmReceiver(int timeoutMs) : m_timeoutMs(timeoutMs) {}
+
+    bool open(const std::string &name, std::string &error) {
+        if (m_reader.open(name) != aditof::Status::OK) {
+            error = "unable to open shared memory " + name;
+            return false;
+        }
+        return true;
+    }
+
+    bool receive(ReceivedFrame &frame, std::string &error) override {
+        aditof::Status status = m_reader.next(m_timeoutMs, m_frame);
+        if (status != aditof::Status::OK) {
+            error = status == aditof::Status::BUSY ? "timeout"
+                                                   : "shared memory closed";
+            return false;
+        }
+
+        frame = ReceivedFrame();
+        frame.header = m_frame.header;
+        frame.hasHeader = true;
+        frame.payload = m_frame.data;
+        frame.payloadSize = m_frame.size;
+        frame.bytes = sizeof(FrameHeader) + m_frame.size;
+        return true;
+    }
+
+    bool isStillValid() const override { return m_reader.isValid(m_frame); }
+
+  private:
+    ShmFrameReader m_reader;
+    ShmFrame m_frame;
+    int m_timeoutMs;
+};
+#endif
+
+class Client {
+  public:
+    Client(zmq::context_t &context, const Options &options)
+        : m_context(context), m_options(options),
+          m_cmd(context, zmq::socket_type::req) {
+        m_cmd.set(zmq::sockopt::rcvtimeo, options.timeoutMs);
+        m_cmd.set(zmq::sockopt::sndtimeo, options.timeoutMs);
+        m_cmd.set(zmq::sockopt::linger, 0);
+        m_cmd.connect("tcp://" + options.ip + ":5556");
+    }
+
+    // Sends a request and waits for its reply. Returns false and sets error
+    // if the request could not be served.
+    bool call(payload::ClientRequest &request, payload::ServerResponse &reply,
+              std::string &error) {
+        const std::string &func = request.func_name();
+        request.set_sensor_index(m_options.sensor);
+        zmq::message_t message(request.ByteSizeLong());
+        request.SerializeWithCachedSizesToArray(
+            static_cast<uint8_t *>(message.data()));
+        if (!m_cmd.send(message, zmq::send_flags::none)) {
+            error = func + ": timeout sending the request";
+            return false;
+        }
+
+        zmq::message_t answer;
+        if (!m_cmd.recv(answer, zmq::recv_flags::none)) {
+            error = func + ": no reply from the server";
+            return false;
+        }
+        if (!reply.ParseFromArray(answer.data(),
+                                  static_cast<int>(answer.size()))) {
+            error = func + ": malformed reply";
+            return false;
+        }
+        if (reply.server_status() != payload::ServerStatus::REQUEST_ACCEPTED) {
+            error = func + ": unknown request";
+            return false;
+        }
+        if (reply.status() != payload::Status::OK) {
+            error = func + ": status " + std::to_string(reply.status()) +
+                    (reply.message().empty() ? "" : " (" + reply.message() +
+                                                        ")");
+            return false;
+        }
+        return true;
+    }
+
+    bool call(const std::string &func, const std::vector<int32_t> &params,
+              payload::ServerResponse &reply, std::string &error) {
+        payload::ClientRequest request;
+        request.set_func_name(func);
+        request.set_expect_reply(true);
+        for (int32_t param : params) {
+            request.add_func_int32_param(param);
+        }
+        return call(request, reply, error);
+    }
+
+    bool call(const std::string &func, const std::vector<int32_t> &params,
+              std::string &error) {
+        payload::ServerResponse reply;
+        return call(func, params, reply, error);
+    }
+
+    // Measures one streaming run: Start, receive frames, Stop
+    RunResult run(const std::string &stream, std::ofstream *record) {
+        RunResult result;
+        result.stream = stream;
+        bool credit = stream == "credit";
+        bool async = stream == "async" || credit;
+
+        if (stream == "async" && !call("RecvAsync", {}, result.error)) {
+            return result;
+        }
+        if (credit && !grantCredits(m_options.credits, result)) {
+            return result;
+        }
+        payload::ClientRequest start;
+        payload::ServerResponse started;
+        start.set_func_name("Start");
+        start.set_expect_reply(true);
+        start.set_compress_frames(m_options.compress);
+        for (const std::string &plane : m_options.packedPlanes) {
+            start.add_packed_planes(plane);
+        }
+        start.set_tile_delta(m_options.tileDelta);
+        start.set_tile_size(m_options.tileSize);
+        start.set_tile_threshold(m_options.tileThreshold);
+        start.set_keyframe_interval(m_options.keyframeInterval);
+        m_tiles.reset();
+        if (m_options.transport == "shm") {
+            start.set_frame_transport(payload::FRAME_TRANSPORT_SHM);
+        }
+        if (!call(start, started, result.error)) {
+            return result;
+        }
+        result.encoding = static_cast<uint16_t>(started.frame_encoding());
+
+        result.transport = started.frame_transport() ==
+                                   payload::FRAME_TRANSPORT_SHM
+                               ? "shm"
+                               : "tcp";
+        std::unique_ptr<FrameReceiver> frames;
+#ifdef WITH_SHM_TRANSPORT
+        if (started.frame_transport() == payload::FRAME_TRANSPORT_SHM) {
+            auto shm = std::make_unique<ShmReceiver>(m_options.timeoutMs);
+            if (!shm->open(started.shm_name(), result.error)) {
+                std::string stopError;
+                call("Stop", {}, stopError);
+                return result;
+            }
+            frames = std::move(shm);
+        }
+#endif
+        if (!frames) {
+            // Servers without several sensors don't give the port
+            uint32_t port =
+                started.stream_port() ? started.stream_port() : 5555;
+            frames = std::make_unique<ZmqReceiver>(
+                m_context,
+                "tcp://" + m_options.ip + ":" + std::to_string(port),
+                m_options.timeoutMs);
+        }
+
+        bool received = receiveFrames(*frames, async, credit, result, record);
+        frames.reset();
+
+        std::string stopError;
+        if (!call("Stop", {}, stopError) && received) {
+            result.error = stopError;
+            return result;
+        }
+        result.ok = received;
+        return result;
+    }
+
+    // Measures watching the stream of another client: Subscribe, receive
+    // frames, Unsubscribe
+    RunResult subscribe(std::ofstream *record) {
+        RunResult result;
+        result.stream = "subscribe";
+        result.transport = "tcp";
+
+        payload::ClientRequest request;
+        payload::ServerResponse reply;
+        request.set_func_name("Subscribe");
+        request.set_expect_reply(true);
+        request.add_func_int32_param(m_options.queueDepth);
+        request.add_func_int32_param(m_options.dropPolicy);
+        for (int32_t value : m_options.region) {
+            request.add_func_int32_param(value);
+        }
+        for (const std::string &plane : m_options.content) {
+            request.add_func_strings_param(plane);
+        }
+        if (!call(request, reply, result.error)) {
+            return result;
+        }
+        if (reply.int32_payload_size() < 2) {
+            result.error = "Subscribe: malformed reply";
+            return result;
+        }
+        const int32_t id = reply.int32_payload(0);
+        const int32_t port = reply.int32_payload(1);
+
+        bool received = false;
+        {
+            ZmqReceiver frames(m_context,
+                               "tcp://" + m_options.ip + ":" +
+                                   std::to_string(port),
+                               m_options.timeoutMs);
+            received = receiveFrames(frames, true, false, result, record);
+        }
+
+        std::string unsubscribeError;
+        if (!call("Unsubscribe", {id}, unsubscribeError) && received) {
+            result.error = unsubscribeError;
+            return result;
+        }
+        result.ok = received;
+        return result;
+    }
+
+    // Applies the commands one request at a time, then all of them in one
+    // Adsd3500Batch request
+    ScriptResult applyScript(const std::vector<payload::Adsd3500Op> &ops) {
+        ScriptResult result;
+        result.commands = ops.size();
+
+        auto begin = std::chrono::steady_clock::now();
+        for (const payload::Adsd3500Op &op : ops) {
+            int32_t cmd = static_cast<int32_t>(op.cmd());
+            int32_t delay = static_cast<int32_t>(op.delay_us());
+            bool ok = op.type() == payload::ADSD3500_OP_READ_CMD
+                          ? call("Adsd3500ReadCmd", {cmd, delay},
+                                 result.error)
+                          : call("Adsd3500WriteCmd",
+                                 {cmd, static_cast<int32_t>(op.value()),
+                                  delay},
+                                 result.error);
+            if (!ok) {
+                return result;
+            }
+        }
+        auto singleEnd = std::chrono::steady_clock::now();
+
+        payload::ClientRequest batch;
+        payload::ServerResponse reply;
+        batch.set_func_name("Adsd3500Batch");
+        batch.set_expect_reply(true);
+        for (const payload::Adsd3500Op &op : ops) {
+            *batch.add_adsd3500_ops() = op;
+        }
+        if (!call(batch, reply, result.error)) {
+            return result;
+        }
+        auto batchEnd = std::chrono::steady_clock::now();
+
+        result.singleMs =
+            std::chrono::duration<double, std::milli>(singleEnd - begin)
+                .count();
+        result.batchMs =
+            std::chrono::duration<double, std::milli>(batchEnd - singleEnd)
+                .count();
+        result.ok = true;
+        return result;
+    }
+
+  private:
+    bool grantCredits(int credits, RunResult &result) {
+        ++result.creditGrants;
+        return call("GrantFrameCredits", {credits}, result.error);
+    }
+
+    bool receiveFrames(FrameReceiver &frames, bool async, bool credit,
+                       RunResult &result, std::ofstream *record) {
+        using clock = std::chrono::steady_clock;
+        const int total = m_options.warmup + m_options.frames;
+        clock::time_point measureStart;
+        clock::time_point previous;
+        bool havePrevious = false;
+        uint64_t lastSequence = 0;
+        uint64_t lastCapture = 0;
+        // Credits are given back in batches of half the window, so the
+        // server always has some left while a grant is in flight
+        const int grantBatch = std::max(1, m_options.credits / 2);
+        int consumed = 0;
+
+        for (int i = 0; i < total; ++i) {
+            bool measuring = i >= m_options.warmup;
+            auto requested = clock::now();
+            if (!async && !call("GetFrame", {}, result.error)) {
+                return false;
+            }
+
+            ReceivedFrame received;
+            if (!frames.receive(received, result.error)) {
+                result.error += " waiting for frame " + std::to_string(i);
+                return false;
+            }
+            int64_t receivedNs = wall_clock_ns();
+            auto now = clock::now();
+
+            if (credit && ++consumed == grantBatch) {
+                consumed = 0;
+                if (!grantCredits(grantBatch, result)) {
+                    return false;
+                }
+            }
+
+            const FrameHeader &header = received.header;
+            const bool hasHeader = received.hasHeader;
+            const uint8_t *frame = received.payload;
+            size_t frameSize = received.payloadSize;
+            if (result.encoding != FRAME_ENCODING_RAW) {
+                auto decodeStart = clock::now();
+                if (decode(result.encoding, frame, frameSize, frame,
+                           frameSize) != aditof::Status::OK) {
+                    result.error = "frame " + std::to_string(i) +
+                                   " can't be decoded";
+                    return false;
+                }
+                if (measuring) {
+                    result.decodeUs.push_back(
+                        std::chrono::duration<double, std::micro>(
+                            clock::now() - decodeStart)
+                            .count());
+                }
+            }
+
+            if (!measuring) {
+                if (i + 1 == m_options.warmup) {
+                    measureStart = clock::now();
+                }
+                lastSequence = header.sequence;
+                lastCapture = header.captureIndex;
+                continue;
+            }
+            if (m_options.warmup == 0 && i == 0) {
+                measureStart = requested;
+            }
+
+            ++result.frames;
+            result.bytes += received.bytes;
+            result.rawBytes += frameSize;
+            if (havePrevious) {
+                result.intervalsUs.push_back(
+                    std::chrono::duration<double, std::micro>(now - previous)
+                        .count());
+            }
+            previous = now;
+            havePrevious = true;
+
+            if (!async) {
+                result.requestLatencyUs.push_back(
+                    std::chrono::duration<double, std::micro>(now - requested)
+                        .count());
+            }
+            if (hasHeader) {
+                if (i > 0) {
+                    if (header.sequence > lastSequence + 1) {
+                        result.sequenceGaps +=
+                            header.sequence - lastSequence - 1;
+                    }
+                    if (header.captureIndex > lastCapture + 1) {
+                        result.captureGaps +=
+                            header.captureIndex - lastCapture - 1;
+                    }
+                }
+                lastSequence = header.sequence;
+                lastCapture = header.captureIndex;
+                result.captureLatencyUs.push_back(
+                    (receivedNs - header.captureTimestamp) / 1000.0);
+                result.sendLatencyUs.push_back(
+                    (receivedNs - header.sendTimestamp) / 1000.0);
+            }
+
+            if (record) {
+                record->write(reinterpret_cast<const char *>(frame),
+                              frameSize);
+            }
+            if (!frames.isStillValid()) {
+                ++result.overwritten;
+            }
+        }
+
+        result.seconds =
+            std::chrono::duration<double>(clock::now() - measureStart).count();
+        return true;
+    }
+
+    // Turns a received payload back into a frame
+    aditof::Status decode(uint16_t encoding, const uint8_t *data, size_t size,
+                          const uint8_t *&frame, size_t &frameSize) {
+        if (encoding == FRAME_ENCODING_TILE_DELTA) {
+            aditof::Status status = m_tiles.decode(data, size);
+            frame = m_tiles.frame().data();
+            frameSize = m_tiles.frame().size();
+            return status;
+        }
+
+        // Both headers start with the size of the decoded frame
+        static_assert(offsetof(FrameCodecHeader, rawSize) ==
+                          offsetof(FramePackHeader, rawSize),
+                      "the headers must agree on rawSize");
+        FrameCodecHeader codecHeader = {};
+        if (size >= sizeof(codecHeader)) {
+            memcpy(&codecHeader, data, sizeof(codecHeader));
+        }
+        m_decoded.resize(codecHeader.rawSize);
+        frame = m_decoded.data();
+        frameSize = m_decoded.size();
+        if (encoding == FRAME_ENCODING_PACK12) {
+            return FramePacker::unpack(data, size, m_decoded.data(),
+                                       m_decoded.size());
+        }
+        return FrameCodec::decode(data, size, m_decoded.data(),
+                                  m_decoded.size());
+    }
+
+    zmq::context_t &m_context;
+    const Options &m_options;
+    zmq::socket_t m_cmd;
+    std::vector<uint8_t> m_decoded;
+    TileDeltaDecoder m_tiles;
+};
+
+const char *encoding_name(uint16_t encoding) {
+    switch (encoding) {
+    case FRAME_ENCODING_DELTA_PACK:
+        return "delta_pack";
+    case FRAME_ENCODING_PACK12:
+        return "pack12";
+    case FRAME_ENCODING_TILE_DELTA:
+        return "tile_delta";
+    default:
+        return "raw";
+    }
+}
+
+void print_summary(const char *name, const std::vector<double> &samples) {
+    if (samples.empty()) {
+        return;
+    }
+    Summary s = summarize(samples);
+    printf("  %-18s p50 %9.1f  p90 %9.1f  p99 %9.1f  max %9.1f  "
+           "stddev %8.1f us\n",
+           name, s.p50, s.p90, s.p99, s.max, s.stddev);
+}
+
+void print_result(const RunResult &r) {
+    printf("%s:\n", r.stream.c_str());
+    if (!r.ok) {
+        printf("  failed: %s\n", r.error.c_str());
+        return;
+    }
+    double mb = r.bytes / (1024.0 * 1024.0);
+    printf("  %llu frames, %.1f MB in %.2f s: %.2f fps, %.1f MB/s\n",
+           static_cast<unsigned long long>(r.frames), mb, r.seconds,
+           r.frames / r.seconds, mb / r.seconds);
+    printf("  dropped by the socket: %llu, before sending: %llu\n",
+           static_cast<unsigned long long>(r.sequenceGaps),
+           static_cast<unsigned long long>(r.captureGaps));
+    if (r.transport == "shm") {
+        printf("  shared memory, overwritten while read: %llu\n",
+               static_cast<unsigned long long>(r.overwritten));
+    }
+    if (r.creditGrants) {
+        printf("  credit grants: %llu\n",
+               static_cast<unsigned long long>(r.creditGrants));
+    }
+    print_summary("inter-frame", r.intervalsUs);
+    print_summary("request->frame", r.requestLatencyUs);
+    print_summary("capture->frame", r.captureLatencyUs);
+    print_summary("send->frame", r.sendLatencyUs);
+    if (r.encoding != FRAME_ENCODING_RAW) {
+        printf("  %s: %.2fx smaller, %.1f MB/s once decoded\n",
+               encoding_name(r.encoding),
+               static_cast<double>(r.rawBytes) / r.bytes,
+               r.rawBytes / (1024.0 * 1024.0) / r.seconds);
+        print_summary("decode", r.decodeUs);
+    }
+}
+
+void json_summary(std::ostream &out, const char *name,
+                  const std::vector<double> &samples) {
+    Summary s = summarize(samples);
+    out << ",\n      \"" << name << "\": {\"count\": " << s.count
+        << ", \"min\": " << s.min << ", \"mean\": " << s.mean
+        << ", \"stddev\": " << s.stddev << ", \"p50\": " << s.p50
+        << ", \"p90\": " << s.p90 << ", \"p99\": " << s.p99
+        << ", \"max\": " << s.max << "}";
+}
+
+std::string json_escape(const std::string &text) {
+    std::string escaped;
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            escaped += '\\';
+        }
+        escaped += c;
+    }
+    return escaped;
+}
+
+void write_json(std::ostream &out, const Options &options,
+                const std::string &sensor,
+                const std::vector<RunResult> &results) {
+    out << "{\n  \"server\": \"" << json_escape(options.ip)
+        << "\",\n  \"sensor\": \"" << json_escape(sensor)
+        << "\",\n  \"mode\": " << options.mode
+        << ",\n  \"frame_header\": " << (options.header ? "true" : "false")
+        << ",\n  \"runs\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const RunResult &r = results[i];
+        double mb = r.bytes / (1024.0 * 1024.0);
+        out << (i ? "," : "") << "\n    {\n      \"stream\": \"" << r.stream
+            << "\",\n      \"ok\": " << (r.ok ? "true" : "false");
+        if (!r.ok) {
+            out << ",\n      \"error\": \"" << json_escape(r.error)
+                << "\"\n    }";
+            continue;
+        }
+        out << ",\n      \"frames\": " << r.frames
+            << ",\n      \"bytes\": " << r.bytes
+            << ",\n      \"raw_bytes\": " << r.rawBytes
+            << ",\n      \"compressed\": "
+            << (r.encoding == FRAME_ENCODING_DELTA_PACK ? "true" : "false")
+            << ",\n      \"encoding\": \"" << encoding_name(r.encoding) << "\""
+            << ",\n      \"seconds\": " << r.seconds
+            << ",\n      \"frames_per_second\": " << r.frames / r.seconds
+            << ",\n      \"megabytes_per_second\": " << mb / r.seconds
+            << ",\n      \"dropped_by_socket\": " << r.sequenceGaps
+            << ",\n      \"dropped_before_send\": " << r.captureGaps
+            << ",\n      \"credit_grants\": " << r.creditGrants
+            << ",\n      \"transport\": \"" << r.transport << "\""
+            << ",\n      \"overwritten\": " << r.overwritten;
+        json_summary(out, "inter_frame_us", r.intervalsUs);
+        json_summary(out, "request_to_frame_us", r.requestLatencyUs);
+        json_summary(out, "capture_to_frame_us", r.captureLatencyUs);
+        json_summary(out, "send_to_frame_us", r.sendLatencyUs);
+        json_summary(out, "decode_us", r.decodeUs);
+        out << "\n    }";
+    }
+    out << "\n  ]\n}\n";
+}
+
+// Reads a register script: one command per line, "read <cmd> [delay_us]"
+// or "write <cmd> <value> [delay_us]", numbers in decimal or 0x hex. Empty
+// lines and lines starting with # are skipped.
+bool load_register_script(const std::string &path,
+                          std::vector<payload::Adsd3500Op> &ops,
+                          std::string &error) {
+    std::ifstream file(path);
+    if (!file) {
+        error = "Unable to open " + path;
+        return false;
+    }
+    int lineNumber = 0;
+    for (std::string line; std::getline(file, line);) {
+        ++lineNumber;
+        std::istringstream words(line);
+        std::string command;
+        if (!(words >> command) || command[0] == '#') {
+            continue;
+        }
+        std::vector<unsigned long> values;
+        for (std::string word; words >> word;) {
+            char *end = nullptr;
+            values.push_back(std::strtoul(word.c_str(), &end, 0));
+            if (*end != '\0') {
+                values.clear();
+                break;
+            }
+        }
+        payload::Adsd3500Op op;
+        op.set_cmd(values.empty() ? 0 : values[0]);
+        if (command == "read" && (values.size() == 1 || values.size() == 2)) {
+            op.set_type(payload::ADSD3500_OP_READ_CMD);
+            op.set_delay_us(values.size() > 1 ? values[1] : 0);
+        } else if (command == "write" &&
+                   (values.size() == 2 || values.size() == 3)) {
+            op.set_type(payload::ADSD3500_OP_WRITE_CMD);
+            op.set_value(values[1]);
+            op.set_delay_us(values.size() > 2 ? values[2] : 0);
+        } else {
+            error = path + ":" + std::to_string(lineNumber) +
+                    ": expected read <cmd> [delay_us] or write <cmd> "
+                    "<value> [delay_us]";
+            return false;
+        }
+        if (values[0] > UINT16_MAX ||
+            (command == "write" && values[1] > UINT16_MAX)) {
+            error = path + ":" + std::to_string(lineNumber) +
+                    ": command and value are 16-bit";
+            return false;
+        }
+        ops.push_back(op);
+    }
+    if (ops.empty()) {
+        error = path + " has no commands";
+        return false;
+    }
+    return true;
+}
+
+void print_script_result(const ScriptResult &r) {
+    if (!r.ok) {
+        printf("register script: failed: %s\n", r.error.c_str());
+        return;
+    }
+    printf("register script: %zu commands, %.2f ms with a request per "
+           "command, %.2f ms batched, %.1fx faster\n",
+           r.commands, r.singleMs, r.batchMs,
+           r.batchMs > 0 ? r.singleMs / r.batchMs : 0.0);
+}
+
+void write_script_json(std::ostream &out, const Options &options,
+                       const std::string &sensor, const ScriptResult &r) {
+    out << "{\n  \"server\": \"" << json_escape(options.ip)
+        << "\",\n  \"sensor\": \"" << json_escape(sensor)
+        << "\",\n  \"register_script\": {\n    \"ok\": "
+        << (r.ok ? "true" : "false");
+    if (r.ok) {
+        out << ",\n    \"commands\": " << r.commands
+            << ",\n    \"single_ms\": " << r.singleMs
+            << ",\n    \"batch_ms\": " << r.batchMs;
+    } else {
+        out << ",\n    \"error\": \"" << json_escape(r.error) << "\"";
+    }
+    out << "\n  }\n}\n";
+}
+
+// Writes the results where --json says, if anywhere
+bool save_json(const Options &options, const std::string &sensor,
+               const std::vector<RunResult> &results) {
+    if (options.jsonPath == "-") {
+        write_json(std::cout, options, sensor, results);
+    } else if (!options.jsonPath.empty()) {
+        std::ofstream json(options.jsonPath);
+        write_json(json, options, sensor, results);
+        if (!json) {
+            std::cerr << "Unable to write " << options.jsonPath << "\n";
+            return false;
+        }
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char *argv[]) {
+    std::map<std::string, struct Argument> command_map = {
+        {"-h", {"--help", false, "", "", false}},
+        {"-ip", {"--ip", false, "", "127.0.0.1", true}},
+        {"-se", {"--sensor", false, "", "0", true}},
+        {"-m", {"--mode", false, "", "0", true}},
+        {"-s", {"--stream", false, "", "all", true}},
+        {"-c", {"--credits", false, "", "8", true}},
+        {"-n", {"--frames", false, "", "300", true}},
+        {"-w", {"--warmup", false, "", "10", true}},
+        {"-nh", {"--no-header", false, "", "", false}},
+        {"-z", {"--compress", false, "", "", false}},
+        {"-p", {"--pack", false, "", "", true}},
+        {"-td", {"--tile-delta", false, "", "", false}},
+        {"-ts", {"--tile-size", false, "", "0", true}},
+        {"-tt", {"--tile-threshold", false, "", "0", true}},
+        {"-ki", {"--keyframe-interval", false, "", "0", true}},
+        {"-ct", {"--content", false, "", "", true}},
+        {"-rg", {"--region", false, "", "", true}},
+        {"-d", {"--decimate", false, "", "1", true}},
+        {"-pl", {"--pooling", false, "", "sample", true}},
+        {"-tr", {"--transport", false, "", "tcp", true}},
+        {"-sb", {"--subscribe", false, "", "", false}},
+        {"-qd", {"--queue-depth", false, "", "2", true}},
+        {"-dp", {"--drop-policy", false, "", "oldest", true}},
+        {"-t", {"--timeout", false, "", "3000", true}},
+        {"-j", {"--json", false, "", "", true}},
+        {"-rc", {"--record", false, "", "", true}},
+        {"-rs", {"--register-script", false, "", "", true}}};
+
+    CommandParser command;
+    std::string arg_error;
+    std::string error;
+
+    command.parseArguments(argc, argv, command_map);
+    int result = command.checkArgumentExist(command_map, arg_error);
+    if (result != 0) {
+        std::cerr << "Argument " << arg_error << " doesn't exist!\n";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    result = command.helpMenu();
+    if (result == 1) {
+        std::cout << Help_Menu;
+        return 0;
+    } else if (result == -1) {
+        std::cerr << "Usage of argument -h/--help is incorrect! Help argument "
+                     "should be used alone!\n";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    result = command.checkValue(command_map, arg_error);
+    if (result != 0) {
+        std::cerr << "Argument: " << command_map[arg_error].long_option
+                  << " doesn't have assigned or default value!\n";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+    Options options;
+    options.ip = command_map["-ip"].value;
+    int sensorIndex = std::atoi(command_map["-se"].value.c_str());
+    options.sensor = static_cast<uint32_t>(std::max(sensorIndex, 0));
+    options.mode = std::atoi(command_map["-m"].value.c_str());
+    options.frames = std::atoi(command_map["-n"].value.c_str());
+    options.warmup = std::atoi(command_map["-w"].value.c_str());
+    options.header = command_map["-nh"].value.empty();
+    options.compress = !command_map["-z"].value.empty();
+    std::stringstream packed(command_map["-p"].value);
+    for (std::string plane; std::getline(packed, plane, ',');) {
+        if (!plane.empty()) {
+            options.packedPlanes.emplace_back(plane);
+        }
+    }
+    std::stringstream content(command_map["-ct"].value);
+    for (std::string plane; std::getline(content, plane, ',');) {
+        if (!plane.empty()) {
+            options.content.emplace_back(plane);
+        }
+    }
+    std::vector<int32_t> region;
+    std::stringstream regionArg(command_map["-rg"].value);
+    for (std::string value; std::getline(regionArg, value, ',');) {
+        region.push_back(std::atoi(value.c_str()));
+    }
+    if (region.empty()) {
+        region.assign(4, 0);
+    }
+    region.push_back(std::atoi(command_map["-d"].value.c_str()));
+    const std::string &pooling = command_map["-pl"].value;
+    const char *poolings[] = {"sample", "min", "median"};
+    auto poolingIndex =
+        std::find(std::begin(poolings), std::end(poolings), pooling) -
+        std::begin(poolings);
+    region.push_back(poolingIndex < 3 ? static_cast<int32_t>(poolingIndex)
+                                      : -1);
+    if (region != std::vector<int32_t>{0, 0, 0, 0, 1, 0}) {
+        options.region = region;
+    }
+    options.tileDelta = !command_map["-td"].value.empty();
+    options.tileSize = std::atoi(command_map["-ts"].value.c_str());
+    options.tileThreshold = std::atoi(command_map["-tt"].value.c_str());
+    options.keyframeInterval = std::atoi(command_map["-ki"].value.c_str());
+    options.transport = command_map["-tr"].value;
+    options.subscribe = !command_map["-sb"].value.empty();
+    options.queueDepth = std::atoi(command_map["-qd"].value.c_str());
+    const std::string &dropPolicy = command_map["-dp"].value;
+    options.dropPolicy =
+        dropPolicy == "oldest" ? 0 : (dropPolicy == "newest" ? 1 : -1);
+    options.timeoutMs = std::atoi(command_map["-t"].value.c_str());
+    options.credits = std::atoi(command_map["-c"].value.c_str());
+    options.jsonPath = command_map["-j"].value;
+    options.recordPath = command_map["-rc"].value;
+    options.scriptPath = command_map["-rs"].value;
+
+    // Runs are ordered by what the server keeps until the client disconnects:
+    // RecvAsync ends sync streaming and granting credits makes streaming
+    // credit based.
+    const std::string &stream = command_map["-s"].value;
+    for (const char *type : {"sync", "async", "credit"}) {
+        if (stream == type || stream == "all") {
+            options.streams.emplace_back(type);
+        }
+    }
+    if (options.streams.empty() || sensorIndex < 0 || options.frames < 2 ||
+        options.warmup < 0 || options.timeoutMs <= 0 || options.credits < 1 ||
+        (options.transport != "tcp" && options.transport != "shm") ||
+        options.queueDepth < 1 || options.dropPolicy < 0 ||
+        (!options.region.empty() &&
+         (options.region.size() != 6 || options.region[5] < 0))) {
+        std::cerr << "Invalid arguments\n";
+        std::cout << Help_Menu;
+        return -1;
+    }
+
+#ifndef WITH_SHM_TRANSPORT
+    if (options.transport == "shm") {
+        std::cerr << "Shared memory transport is not available on this "
+                     "platform\n";
+        return -1;
+    }
+#endif
+
+    std::vector<payload::Adsd3500Op> script;
+    if (!options.scriptPath.empty() &&
+        !load_register_script(options.scriptPath, script, error)) {
+        std::cerr << error << "\n";
+        return -1;
+    }
+
+    std::unique_ptr<std::ofstream> record;
+    if (!options.recordPath.empty()) {
+        record.reset(new std::ofstream(options.recordPath, std::ios::binary));
+        if (!*record) {
+            std::cerr << "Unable to open " << options.recordPath << "\n";
+            return -1;
+        }
+    }
+
+    zmq::context_t context(1);
+    Client client(context, options);
+    payload::ServerResponse reply;
+
+    // A subscriber leaves the camera to the client operating it
+    if (options.subscribe) {
+        std::cout << "Subscribing to the stream of " << options.ip << "\n";
+        std::vector<RunResult> results{client.subscribe(record.get())};
+        print_result(results.back());
+        if (!save_json(options, "", results)) {
+            return -1;
+        }
+        return results.back().ok ? 0 : 1;
+    }
+
+    if (!client.call("ServerConnect", {}, reply, error)) {
+        std::cerr << error << "\n";
+        return -1;
+    }
+    if (reply.message() != "Connection Allowed") {
+        std::cerr << "Server refused the connection: " << reply.message()
+                  << "\n";
+        return -1;
+    }
+
+    reply.Clear();
+    if (!client.call("FindSensors", {}, reply, error)) {
+        std::cerr << error << "\n";
+        return -1;
+    }
+    std::string sensor = reply.sensors_info().image_sensors().name();
+
+    // An ini set is applied after the mode is set, like the SDK does
+    if (!script.empty()) {
+        if (!client.call("Open", {}, error) ||
+            !client.call("SetModeByIndex", {options.mode}, error)) {
+            std::cerr << error << "\n";
+            client.call("HangUp", {}, error);
+            return -1;
+        }
+        std::cout << "Applying " << options.scriptPath << " to " << sensor
+                  << " on " << options.ip << "\n";
+        ScriptResult applied = client.applyScript(script);
+        print_script_result(applied);
+        client.call("HangUp", {}, error);
+
+        if (options.jsonPath == "-") {
+            write_script_json(std::cout, options, sensor, applied);
+        } else if (!options.jsonPath.empty()) {
+            std::ofstream json(options.jsonPath);
+            write_script_json(json, options, sensor, applied);
+            if (!json) {
+                std::cerr << "Unable to write " << options.jsonPath << "\n";
+                return -1;
+            }
+        }
+        return applied.ok ? 0 : 1;
+    }
+
+    payload::ClientRequest setContent;
+    setContent.set_func_name("SetFrameContent");
+    setContent.set_expect_reply(true);
+    for (const std::string &plane : options.content) {
+        setContent.add_func_strings_param(plane);
+    }
+    payload::ClientRequest setRegion;
+    setRegion.set_func_name("SetFrameRegion");
+    setRegion.set_expect_reply(true);
+    for (int32_t value : options.region) {
+        setRegion.add_func_int32_param(value);
+    }
+
+    if (!client.call("Open", {}, error) ||
+        !client.call("SetModeByIndex", {options.mode}, error) ||
+        (options.header && !client.call("SetFrameHeader", {1}, error)) ||
+        (!options.content.empty() && !client.call(setContent, reply, error)) ||
+        (!options.region.empty() && !client.call(setRegion, reply, error))) {
+        std::cerr << error << "\n";
+        client.call("HangUp", {}, error);
+        return -1;
+    }
+
+    std::cout << "Streaming mode " << options.mode << " of " << sensor
+              << " from " << options.ip << "\n";
+
+    std::vector<RunResult> results;
+    bool allOk = true;
+    for (const std::string &run : options.streams) {
+        results.emplace_back(client.run(run, record.get()));
+        print_result(results.back());
+        allOk = allOk && results.back().ok;
+        // Only the first run is recorded
+        record.reset();
+    }
+
+    client.call("HangUp", {}, error);
+
+    if (!save_json(options, sensor, results)) {
+        return -1;
+    }
+
+    return allOk ? 0 : 1;
+}
@@ -0,0 +1,195 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_codec.h"
+#include "server_test.h"
+
+#include <cstring>
+
+namespace {
+
+std::vector<uint8_t> encode(FrameCodec &codec,
+                            const std::vector<uint8_t> &frame) {
+    std::vector<uint8_t> out(codec.maxEncodedSize());
+    // Bands are independent, the order they are encoded in doesn't matter
+    for (size_t i = codec.segmentCount(); i > 0; --i) {
+        codec.encodeSegment(frame.data(), i - 1, out.data());
+    }
+    out.resize(codec.finish(out.data()));
+    return out;
+}
+
+bool check_round_trip(uint16_t layout, uint16_t width, uint16_t height,
+                      uint16_t planeCount, std::mt19937 &rng) {
+    const size_t size = layout_frame_size(layout, width, height, planeCount);
+    FrameCodec codec;
+    EXPECT(codec.configure(layout, width, height, planeCount, size) ==
+           aditof::Status::OK);
+
+    for (bool noise : {false, true}) {
+        std::vector<uint8_t> frame = make_frame(size, rng);
+        if (noise) {
+            for (auto &byte : frame) {
+                byte = static_cast<uint8_t>(rng());
+            }
+        }
+        const std::vector<uint8_t> encoded = encode(codec, frame);
+        EXPECT(encoded.size() <= codec.maxEncodedSize());
+        if (!noise && size >= 4096) {
+            EXPECT(encoded.size() < size / 2);
+        }
+
+        std::vector<uint8_t> decoded(size, 0xa5);
+        EXPECT(FrameCodec::decode(encoded.data(), encoded.size(),
+                                  decoded.data(),
+                                  decoded.size()) == aditof::Status::OK);
+        EXPECT(decoded == frame);
+    }
+    return true;
+}
+
+bool check_round_trips() {
+    std::mt19937 rng(1);
+    const uint16_t selected[] = {
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_DEPTH,
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_AB | FRAME_CONTENT_METADATA,
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+            FRAME_CONTENT_CONF | FRAME_CONTENT_METADATA};
+    for (uint16_t width : {64, 33, 1}) {
+        for (uint16_t height : {48, 7}) {
+            EXPECT(check_round_trip(FRAME_LAYOUT_DEPTH_AB_CONF, width, height,
+                                    1, rng));
+            EXPECT(check_round_trip(FRAME_LAYOUT_DEPTH_AB, width, height, 1,
+                                    rng));
+            EXPECT(check_round_trip(FRAME_LAYOUT_PCM, width, height, 3, rng));
+            for (uint16_t layout : selected) {
+                EXPECT(check_round_trip(layout, width, height, 1, rng));
+            }
+        }
+    }
+
+    // Frames that don't match their layout are coded as plain rows
+    for (size_t size : {2, 1002, 65538}) {
+        FrameCodec codec;
+        EXPECT(codec.configure(FRAME_LAYOUT_DEPTH_AB, 64, 48, 1, size) ==
+               aditof::Status::OK);
+        const std::vector<uint8_t> frame = make_frame(size, rng);
+        const std::vector<uint8_t> encoded = encode(codec, frame);
+        std::vector<uint8_t> decoded(size);
+        EXPECT(FrameCodec::decode(encoded.data(), encoded.size(),
+                                  decoded.data(),
+                                  decoded.size()) == aditof::Status::OK);
+        EXPECT(decoded == frame);
+    }
+
+    FrameCodec codec;
+    EXPECT(codec.configure(FRAME_LAYOUT_DEPTH_AB, 64, 48, 1, 0) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(codec.configure(FRAME_LAYOUT_DEPTH_AB, 64, 48, 1, 1001) ==
+           aditof::Status::INVALID_ARGUMENT);
+    return true;
+}
+
+bool check_malformed() {
+    std::mt19937 rng(2);
+    const uint16_t width = 40;
+    const uint16_t height = 30;
+    const size_t size =
+        layout_frame_size(FRAME_LAYOUT_DEPTH_AB_CONF, width, height, 1);
+    FrameCodec codec;
+    EXPECT(codec.configure(FRAME_LAYOUT_DEPTH_AB_CONF, width, height, 1,
+                           size) == aditof::Status::OK);
+    const std::vector<uint8_t> frame = make_frame(size, rng);
+    const std::vector<uint8_t> encoded = encode(codec, frame);
+    std::vector<uint8_t> decoded(size);
+
+    // Shorter than a header, cut short and too large for the frame
+    EXPECT(FrameCodec::decode(encoded.data(), sizeof(FrameCodecHeader) - 1,
+                              decoded.data(), decoded.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(FrameCodec::decode(encoded.data(), encoded.size() - 1,
+                              decoded.data(), decoded.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(FrameCodec::decode(encoded.data(), encoded.size(), decoded.data(),
+                              decoded.size() - 2) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    std::vector<uint8_t> bad = encoded;
+    bad[0] ^= 0xff;
+    EXPECT(FrameCodec::decode(bad.data(), bad.size(), decoded.data(),
+                              decoded.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    // A band that claims to lie past the end of the frame
+    bad = encoded;
+    FrameCodecSegment segment;
+    memcpy(&segment, bad.data() + sizeof(FrameCodecHeader), sizeof(segment));
+    segment.rawOffset = static_cast<uint32_t>(size);
+    memcpy(bad.data() + sizeof(FrameCodecHeader), &segment, sizeof(segment));
+    EXPECT(FrameCodec::decode(bad.data(), bad.size(), decoded.data(),
+                              decoded.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    // A band larger than the data that follows
+    bad = encoded;
+    memcpy(&segment, bad.data() + sizeof(FrameCodecHeader), sizeof(segment));
+    segment.encodedBytes = static_cast<uint32_t>(bad.size());
+    memcpy(bad.data() + sizeof(FrameCodecHeader), &segment, sizeof(segment));
+    EXPECT(FrameCodec::decode(bad.data(), bad.size(), decoded.data(),
+                              decoded.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    // Corrupted bands must be rejected or decode to something, never read
+    // or write out of bounds
+    for (int i = 0; i < 1000; ++i) {
+        bad = encoded;
+        const size_t header = sizeof(FrameCodecHeader);
+        bad[header + rng() % (bad.size() - header)] =
+            static_cast<uint8_t>(rng());
+        FrameCodec::decode(bad.data(), bad.size(), decoded.data(),
+                           decoded.size());
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_alsologtostderr = 1;
+
+    bool passed = check_round_trips();
+    passed = check_malformed() && passed;
+    if (passed) {
+        LOG(INFO) << "@@," << TEST_NAME << ",PASS,LN" << __LINE__;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,249 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_pack.h"
+#include "server_test.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+const uint16_t MAX_VALUE = 0xfff;
+
+#if defined(FRAME_PACK_SCALAR)
+const char *const kernels = "scalar";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+const char *const kernels = "NEON";
+#elif defined(__SSSE3__)
+const char *const kernels = "SSSE3";
+#else
+const char *const kernels = "scalar";
+#endif
+
+uint16_t value_at(const std::vector<uint8_t> &frame, size_t offset) {
+    uint16_t value;
+    memcpy(&value, &frame[offset], sizeof(value));
+    return value;
+}
+
+/**
+ * The packing described in frame_pack.h, one value at a time.
+ */
+void reference_pack(const std::vector<uint8_t> &frame, size_t offset,
+                    size_t count, std::vector<uint8_t> &out) {
+    for (size_t i = 0; i < count; i += 2) {
+        const uint16_t v0 =
+            std::min(value_at(frame, offset + i * 2), MAX_VALUE);
+        if (i + 1 == count) {
+            out.push_back(static_cast<uint8_t>(v0));
+            out.push_back(static_cast<uint8_t>(v0 >> 8));
+            break;
+        }
+        const uint16_t v1 =
+            std::min(value_at(frame, offset + i * 2 + 2), MAX_VALUE);
+        out.push_back(static_cast<uint8_t>(v0));
+        out.push_back(static_cast<uint8_t>((v0 >> 8) | (v1 << 4)));
+        out.push_back(static_cast<uint8_t>(v1 >> 4));
+    }
+}
+
+/**
+ * Frame of random 16-bit values, a quarter of them above what 12 bits hold
+ * and some right at the limit.
+ */
+std::vector<uint8_t> make_values(size_t size, std::mt19937 &rng) {
+    std::vector<uint8_t> frame(size);
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        uint16_t value;
+        switch (rng() % 8) {
+        case 0:
+            value = static_cast<uint16_t>(MAX_VALUE + 1 + rng() % 0xf000);
+            break;
+        case 1:
+            value = (rng() % 2) ? MAX_VALUE : MAX_VALUE + 1;
+            break;
+        default:
+            value = static_cast<uint16_t>(rng() % (MAX_VALUE + 1));
+            break;
+        }
+        memcpy(&frame[i], &value, sizeof(value));
+    }
+    return frame;
+}
+
+bool check_frame(uint16_t layout, uint16_t width, uint16_t height,
+                 uint16_t packedContent, std::mt19937 &rng) {
+    const size_t plane = static_cast<size_t>(width) * height;
+    const size_t size = layout_frame_size(layout, width, height, 1);
+    FramePacker packer;
+    EXPECT(packer.configure(layout, width, height, size, packedContent) ==
+           aditof::Status::OK);
+
+    const std::vector<uint8_t> frame = make_values(size, rng);
+    std::vector<uint8_t> packed(packer.packedSize());
+    packer.pack(frame.data(), packed.data());
+
+    // The planes as the format describes them: packed ones are clamped and
+    // the metadata at the start of AB is copied
+    uint16_t content = layout & (FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+                                 FRAME_CONTENT_CONF | FRAME_CONTENT_METADATA);
+    if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+        content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB | FRAME_CONTENT_CONF;
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB) {
+        content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB;
+    }
+    const size_t sizes[] = {plane * 2, plane * 2, plane * 4,
+                            FRAME_METADATA_SIZE};
+    std::vector<uint8_t> runs;
+    std::vector<uint8_t> expected = frame;
+    size_t offset = 0;
+    for (size_t i = 0; i < 4; ++i) {
+        const uint16_t bit = static_cast<uint16_t>(1u << i);
+        if (!(content & bit)) {
+            continue;
+        }
+        size_t raw = (packedContent & bit) ? 0 : sizes[i];
+        if ((packedContent & bit) && bit == FRAME_CONTENT_AB) {
+            raw = FRAME_METADATA_SIZE;
+        }
+        runs.insert(runs.end(), frame.begin() + offset,
+                    frame.begin() + offset + raw);
+        const size_t count = (sizes[i] - raw) / sizeof(uint16_t);
+        reference_pack(frame, offset + raw, count, runs);
+        for (size_t j = offset + raw; j < offset + sizes[i]; j += 2) {
+            const uint16_t value = std::min(value_at(frame, j), MAX_VALUE);
+            memcpy(&expected[j], &value, sizeof(value));
+        }
+        offset += sizes[i];
+    }
+
+    // Every build packs to the same bytes
+    FramePackHeader header;
+    memcpy(&header, packed.data(), sizeof(header));
+    const size_t tableEnd =
+        sizeof(header) + header.segmentCount * sizeof(FramePackSegment);
+    EXPECT(header.rawSize == size);
+    EXPECT(header.packedSize == packed.size());
+    EXPECT(packed.size() == tableEnd + runs.size());
+    EXPECT(std::equal(runs.begin(), runs.end(), packed.begin() + tableEnd));
+
+    std::vector<uint8_t> unpacked(size, 0xa5);
+    EXPECT(FramePacker::unpack(packed.data(), packed.size(), unpacked.data(),
+                               unpacked.size()) == aditof::Status::OK);
+    EXPECT(unpacked == expected);
+    return true;
+}
+
+bool check_frames() {
+    std::mt19937 rng(6);
+    const uint16_t both = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB;
+    const uint16_t selected =
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+        FRAME_CONTENT_CONF | FRAME_CONTENT_METADATA;
+
+    // Odd and even widths of every length the kernels and their tails see
+    for (uint16_t width = 64; width <= 97; ++width) {
+        for (uint16_t height : {1, 3}) {
+            EXPECT(check_frame(FRAME_LAYOUT_DEPTH_AB_CONF, width, height, both,
+                               rng));
+            EXPECT(check_frame(FRAME_LAYOUT_DEPTH_AB, width, height,
+                               FRAME_CONTENT_AB, rng));
+            EXPECT(check_frame(FRAME_LAYOUT_SELECTED | FRAME_CONTENT_DEPTH,
+                               width, height, FRAME_CONTENT_DEPTH, rng));
+            EXPECT(check_frame(selected, width, height, both, rng));
+        }
+    }
+    EXPECT(check_frame(FRAME_LAYOUT_DEPTH_AB_CONF, 512, 512, both, rng));
+    EXPECT(check_frame(FRAME_LAYOUT_DEPTH_AB, 1024, 1024, both, rng));
+    return true;
+}
+
+bool check_invalid() {
+    std::mt19937 rng(7);
+    FramePacker packer;
+    // Nothing to pack, frames of another size, planes too small to hold
+    // the metadata
+    EXPECT(packer.configure(FRAME_LAYOUT_PCM, 64, 64, 64 * 64 * 2,
+                            FRAME_CONTENT_DEPTH) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(packer.configure(FRAME_LAYOUT_DEPTH_AB, 64, 64, 1000,
+                            FRAME_CONTENT_DEPTH) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(packer.configure(FRAME_LAYOUT_DEPTH_AB, 8, 4, 8 * 4 * 4,
+                            FRAME_CONTENT_DEPTH) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    const size_t size = 64 * 64 * 4;
+    EXPECT(packer.configure(FRAME_LAYOUT_DEPTH_AB, 64, 64, size,
+                            FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB) ==
+           aditof::Status::OK);
+    std::vector<uint8_t> packed(packer.packedSize());
+    packer.pack(make_values(size, rng).data(), packed.data());
+    std::vector<uint8_t> unpacked(size);
+    EXPECT(FramePacker::unpack(packed.data(), packed.size() - 1,
+                               unpacked.data(), unpacked.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(FramePacker::unpack(packed.data(), packed.size(), unpacked.data(),
+                               unpacked.size() - 2) ==
+           aditof::Status::INVALID_ARGUMENT);
+    std::vector<uint8_t> bad = packed;
+    bad[0] ^= 0xff;
+    EXPECT(FramePacker::unpack(bad.data(), bad.size(), unpacked.data(),
+                               unpacked.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    // Corrupted frames must be rejected or unpacked, never read or write
+    // out of bounds
+    for (int i = 0; i < 1000; ++i) {
+        bad = packed;
+        bad[rng() % (sizeof(FramePackHeader) + 2 * sizeof(FramePackSegment))] =
+            static_cast<uint8_t>(rng());
+        FramePacker::unpack(bad.data(), bad.size(), unpacked.data(),
+                            unpacked.size());
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_alsologtostderr = 1;
+
+    bool passed = check_frames();
+    passed = check_invalid() && passed;
+    if (passed) {
+        LOG(INFO) << "@@," << TEST_NAME << ",PASS,LN" << __LINE__
+                  << ",DN:" << kernels;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,159 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_ring.h"
+#include "server_test.h"
+
+#include <atomic>
+#include <thread>
+
+namespace {
+
+bool check_drop_oldest() {
+    int frames[6] = {0, 1, 2, 3, 4, 5};
+    FrameRing<int> ring(3, DropPolicy::DROP_OLDEST);
+    EXPECT(ring.empty());
+    EXPECT(ring.pop() == nullptr);
+
+    for (int i = 0; i < 3; ++i) {
+        EXPECT(ring.push(&frames[i]) == nullptr);
+    }
+    EXPECT(ring.size() == 3);
+
+    // The oldest frames make room for the latest ones
+    EXPECT(ring.push(&frames[3]) == &frames[0]);
+    EXPECT(ring.push(&frames[4]) == &frames[1]);
+    EXPECT(ring.size() == 3);
+    EXPECT(ring.droppedOldest() == 2);
+    EXPECT(ring.droppedNewest() == 0);
+
+    EXPECT(ring.pop() == &frames[2]);
+    EXPECT(ring.push(&frames[5]) == nullptr);
+    EXPECT(ring.pop() == &frames[3]);
+    EXPECT(ring.pop() == &frames[4]);
+    EXPECT(ring.pop() == &frames[5]);
+    EXPECT(ring.pop() == nullptr);
+    EXPECT(ring.empty());
+    return true;
+}
+
+bool check_drop_newest() {
+    int frames[5] = {0, 1, 2, 3, 4};
+    FrameRing<int> ring(2, DropPolicy::DROP_NEWEST);
+    EXPECT(ring.push(&frames[0]) == nullptr);
+    EXPECT(ring.push(&frames[1]) == nullptr);
+
+    // What is queued stays, the frame being pushed is handed back
+    EXPECT(ring.push(&frames[2]) == &frames[2]);
+    EXPECT(ring.push(&frames[3]) == &frames[3]);
+    EXPECT(ring.droppedNewest() == 2);
+    EXPECT(ring.droppedOldest() == 0);
+
+    EXPECT(ring.pop() == &frames[0]);
+    EXPECT(ring.push(&frames[4]) == nullptr);
+    EXPECT(ring.pop() == &frames[1]);
+    EXPECT(ring.pop() == &frames[4]);
+    EXPECT(ring.pop() == nullptr);
+
+    // A capacity of 0 holds a single frame
+    ring.reset(0, DropPolicy::DROP_OLDEST);
+    EXPECT(ring.capacity() == 1);
+    EXPECT(ring.policy() == DropPolicy::DROP_OLDEST);
+    EXPECT(ring.push(&frames[0]) == nullptr);
+    EXPECT(ring.push(&frames[1]) == &frames[0]);
+    EXPECT(ring.pop() == &frames[1]);
+    return true;
+}
+
+/**
+ * Producer and consumer on their own threads: every frame is either popped,
+ * in order, or handed back by push() exactly once.
+ */
+bool check_threads(DropPolicy policy) {
+    const int count = 200000;
+    std::vector<int> frames(count);
+    for (int i = 0; i < count; ++i) {
+        frames[i] = i;
+    }
+
+    FrameRing<int> ring(3, policy);
+    std::vector<int> seen(count, 0);
+    std::atomic<bool> done{false};
+    bool ordered = true;
+    std::thread consumer([&]() {
+        int last = -1;
+        while (!done || !ring.empty()) {
+            int *frame = ring.pop();
+            if (!frame) {
+                std::this_thread::yield();
+                continue;
+            }
+            ordered = ordered && *frame > last;
+            last = *frame;
+            ++seen[*frame];
+        }
+    });
+
+    uint64_t dropped = 0;
+    for (int i = 0; i < count; ++i) {
+        int *frame = ring.push(&frames[i]);
+        if (frame) {
+            ++dropped;
+            // The consumer never touches a dropped frame, no race on seen
+            seen[*frame] += 1000;
+        }
+    }
+    done = true;
+    consumer.join();
+
+    EXPECT(ordered);
+    EXPECT(dropped == ring.droppedOldest() + ring.droppedNewest());
+    for (int i = 0; i < count; ++i) {
+        EXPECT(seen[i] == 1 || seen[i] == 1000);
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_alsologtostderr = 1;
+
+    bool passed = check_drop_oldest();
+    passed = check_drop_newest() && passed;
+    passed = check_threads(DropPolicy::DROP_OLDEST) && passed;
+    passed = check_threads(DropPolicy::DROP_NEWEST) && passed;
+    if (passed) {
+        LOG(INFO) << "@@," << TEST_NAME << ",PASS,LN" << __LINE__;
+    }
+    return passed ? 0 : 1;
+}
@@ -0,0 +1,262 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "frame_transform.h"
+#include "server_test.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace {
+
+#if defined(FRAME_TRANSFORM_SCALAR)
+const char *const kernels = "scalar";
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+const char *const kernels = "NEON";
+#elif defined(__SSE2__)
+const char *const kernels = "SSE2";
+#else
+const char *const kernels = "scalar";
+#endif
+
+template <typename T> T value_at(const std::vector<uint8_t> &frame, size_t i) {
+    T value;
+    memcpy(&value, &frame[i * sizeof(T)], sizeof(T));
+    return value;
+}
+
+template <typename T>
+void set_value(std::vector<uint8_t> &frame, size_t i, T value) {
+    memcpy(&frame[i * sizeof(T)], &value, sizeof(T));
+}
+
+/**
+ * Frame of random values, a quarter of them invalid (zero) and some at the
+ * ends of the 16-bit range and around its middle.
+ */
+std::vector<uint8_t> make_values(size_t size, std::mt19937 &rng) {
+    std::vector<uint8_t> frame(size);
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        uint16_t value;
+        switch (rng() % 8) {
+        case 0:
+        case 1:
+            value = 0;
+            break;
+        case 2: {
+            const uint16_t edges[] = {1, 2, 0x7fff, 0x8000, 0x8001, 0xffff};
+            value = edges[rng() % 6];
+            break;
+        }
+        default:
+            value = static_cast<uint16_t>(rng());
+            break;
+        }
+        set_value(frame, i / 2, value);
+    }
+    return frame;
+}
+
+/**
+ * A decimated pixel of a 16-bit plane as FrameRegion describes it, one block
+ * at a time.
+ */
+uint16_t reference_pixel(const std::vector<uint8_t> &frame, size_t plane,
+                         size_t width, size_t x, size_t y, size_t d,
+                         FramePooling pooling) {
+    if (pooling == FramePooling::SAMPLE) {
+        return value_at<uint16_t>(frame, plane + y * width + x);
+    }
+    std::vector<uint16_t> valid;
+    for (size_t r = 0; r < d; ++r) {
+        for (size_t c = 0; c < d; ++c) {
+            uint16_t value =
+                value_at<uint16_t>(frame, plane + (y + r) * width + x + c);
+            if (value) {
+                valid.push_back(value);
+            }
+        }
+    }
+    if (valid.empty()) {
+        return 0;
+    }
+    std::sort(valid.begin(), valid.end());
+    return pooling == FramePooling::MIN ? valid.front()
+                                        : valid[(valid.size() - 1) / 2];
+}
+
+bool check_transform(uint16_t layout, uint16_t width, uint16_t height,
+                     uint16_t planeCount, const FrameRegion &region,
+                     std::mt19937 &rng) {
+    const size_t size = layout_frame_size(layout, width, height, planeCount);
+    FrameTransform transform;
+    EXPECT(transform.configure(layout, width, height, planeCount, region) ==
+           aditof::Status::OK);
+
+    const size_t d = region.decimation;
+    const size_t regionWidth = region.width ? region.width : width;
+    const size_t regionHeight = region.height ? region.height : height;
+    const size_t outWidth = regionWidth / d;
+    const size_t outHeight = regionHeight / d;
+    EXPECT(transform.outputWidth() == outWidth);
+    EXPECT(transform.outputHeight() == outHeight);
+    const size_t in = static_cast<size_t>(width) * height;
+    const size_t out = outWidth * outHeight;
+    EXPECT(transform.outputSize() ==
+           layout_frame_size(layout, static_cast<uint16_t>(outWidth),
+                             static_cast<uint16_t>(outHeight), planeCount));
+
+    // The planes as FrameRegion describes them, the metadata at the start
+    // of AB carried over
+    const std::vector<uint8_t> frame = make_values(size, rng);
+    std::vector<uint8_t> expected(transform.outputSize());
+    const bool pcm = layout == FRAME_LAYOUT_PCM;
+    const size_t planes16 = pcm ? planeCount : 2;
+    for (size_t p = 0; p < planes16; ++p) {
+        const FramePooling pooling =
+            (!pcm && p == 0 && d > 1) ? region.pooling : FramePooling::SAMPLE;
+        for (size_t y = 0; y < outHeight; ++y) {
+            for (size_t x = 0; x < outWidth; ++x) {
+                set_value(expected, p * out + y * outWidth + x,
+                          reference_pixel(frame, p * in, width,
+                                          region.x + x * d, region.y + y * d,
+                                          d, pooling));
+            }
+        }
+    }
+    if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+        for (size_t y = 0; y < outHeight; ++y) {
+            for (size_t x = 0; x < outWidth; ++x) {
+                const size_t pixel =
+                    (region.y + y * d) * width + region.x + x * d;
+                set_value(expected, out + y * outWidth + x,
+                          value_at<uint32_t>(frame, in + pixel));
+            }
+        }
+    }
+    if (!pcm) {
+        memcpy(&expected[out * 2], &frame[in * 2], FRAME_METADATA_SIZE);
+    }
+
+    // Bands are independent, the order they are transformed in doesn't
+    // matter
+    std::vector<uint8_t> transformed(transform.outputSize(), 0xa5);
+    for (size_t band = transform.bandCount(); band > 0; --band) {
+        transform.apply(frame.data(), transformed.data(), band - 1);
+    }
+    transform.finish(frame.data(), transformed.data());
+    EXPECT(transformed == expected);
+    return true;
+}
+
+bool check_frames() {
+    std::mt19937 rng(8);
+    const FramePooling poolings[] = {FramePooling::SAMPLE, FramePooling::MIN,
+                                     FramePooling::MEDIAN};
+
+    // Odd and even output widths of every length the kernels and their tails
+    // see, whole and cropped
+    for (uint16_t width = 64; width <= 97; ++width) {
+        for (uint16_t d = 1; d <= 4; ++d) {
+            for (FramePooling pooling : poolings) {
+                FrameRegion whole;
+                whole.decimation = d;
+                whole.pooling = pooling;
+                EXPECT(check_transform(FRAME_LAYOUT_DEPTH_AB_CONF, width, 32,
+                                       1, whole, rng));
+                EXPECT(check_transform(FRAME_LAYOUT_DEPTH_AB, width, 32, 1,
+                                       whole, rng));
+
+                FrameRegion cropped = whole;
+                cropped.x = 3;
+                cropped.y = 5;
+                cropped.width = static_cast<uint16_t>(width - 7);
+                cropped.height = 25;
+                EXPECT(check_transform(FRAME_LAYOUT_DEPTH_AB_CONF, width, 32,
+                                       1, cropped, rng));
+                EXPECT(check_transform(FRAME_LAYOUT_PCM, width, 32, 3,
+                                       cropped, rng));
+            }
+        }
+    }
+
+    FrameRegion half;
+    half.decimation = 2;
+    half.pooling = FramePooling::MIN;
+    EXPECT(check_transform(FRAME_LAYOUT_DEPTH_AB_CONF, 512, 512, 1, half,
+                           rng));
+    half.pooling = FramePooling::SAMPLE;
+    EXPECT(check_transform(FRAME_LAYOUT_DEPTH_AB, 1024, 1024, 1, half, rng));
+    return true;
+}
+
+bool check_invalid() {
+    FrameTransform transform;
+    FrameRegion region;
+
+    // Outside of the image, decimation out of range, output AB plane too
+    // small to hold the metadata, unknown layout
+    region.x = 1;
+    region.width = 64;
+    region.height = 64;
+    EXPECT(transform.configure(FRAME_LAYOUT_DEPTH_AB, 64, 64, 1, region) ==
+           aditof::Status::INVALID_ARGUMENT);
+    region = FrameRegion();
+    region.decimation = 0;
+    EXPECT(transform.configure(FRAME_LAYOUT_DEPTH_AB, 64, 64, 1, region) ==
+           aditof::Status::INVALID_ARGUMENT);
+    region.decimation = 9;
+    EXPECT(transform.configure(FRAME_LAYOUT_DEPTH_AB, 64, 64, 1, region) ==
+           aditof::Status::INVALID_ARGUMENT);
+    region.decimation = 8;
+    EXPECT(transform.configure(FRAME_LAYOUT_DEPTH_AB, 32, 32, 1, region) ==
+           aditof::Status::INVALID_ARGUMENT);
+    region.decimation = 1;
+    EXPECT(transform.configure(FRAME_LAYOUT_SELECTED | FRAME_CONTENT_DEPTH,
+                               64, 64, 1, region) ==
+           aditof::Status::INVALID_ARGUMENT);
+    return true;
+}
+
+} // namespace
+
+int main(int, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_alsologtostderr = 1;
+
+    bool passed = check_frames();
+    passed = check_invalid() && passed;
+    if (passed) {
+        LOG(INFO) << "@@," << TEST_NAME << ",PASS,LN" << __LINE__
+                  << ",DN:" << kernels;
+    }
+    return passed ? 0 : 1;
+}
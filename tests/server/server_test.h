@@ -0,0 +1,96 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#ifndef SERVER_TEST_H
+#define SERVER_TEST_H
+
+#include "frame_header.h"
+
+#include <aditof/log.h>
+
+#include <cstddef>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Logs a FAIL line (see tests/README.md) and makes the enclosing
+ * check return false when cond does not hold.
+ */
+#define EXPECT(cond)                                                           \
+    do {                                                                       \
+        if (!(cond)) {                                                         \
+            LOG(ERROR) << "@@," << TEST_NAME << ",FAIL,LN" << __LINE__        \
+                       << ",DN:" << #cond;                                     \
+            return false;                                                      \
+        }                                                                      \
+    } while (0)
+
+/**
+ * @brief Frame of 16-bit values that drift like a depth or AB plane.
+ */
+inline std::vector<uint8_t> make_frame(size_t size, std::mt19937 &rng) {
+    std::vector<uint8_t> frame(size);
+    uint16_t value = 1000;
+    for (size_t i = 0; i + 1 < size; i += 2) {
+        value = static_cast<uint16_t>(value + rng() % 9 - 4);
+        frame[i] = static_cast<uint8_t>(value);
+        frame[i + 1] = static_cast<uint8_t>(value >> 8);
+    }
+    if (size % 2) {
+        frame[size - 1] = static_cast<uint8_t>(rng());
+    }
+    return frame;
+}
+
+/**
+ * @brief Size of a frame laid out as given (FrameLayout) in the server.
+ */
+inline size_t layout_frame_size(uint16_t layout, uint16_t width,
+                                uint16_t height, uint16_t planeCount) {
+    const size_t plane = static_cast<size_t>(width) * height;
+    if (layout & FRAME_LAYOUT_SELECTED) {
+        return ((layout & FRAME_CONTENT_DEPTH) ? plane * 2 : 0) +
+               ((layout & FRAME_CONTENT_AB) ? plane * 2 : 0) +
+               ((layout & FRAME_CONTENT_CONF) ? plane * 4 : 0) +
+               ((layout & FRAME_CONTENT_METADATA) ? FRAME_METADATA_SIZE : 0);
+    }
+    switch (layout) {
+    case FRAME_LAYOUT_DEPTH_AB_CONF:
+        return plane * 8;
+    case FRAME_LAYOUT_DEPTH_AB:
+        return plane * 4;
+    default:
+        return plane * 2 * planeCount;
+    }
+}
+
+#endif // SERVER_TEST_H
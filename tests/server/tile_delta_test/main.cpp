@@ -0,0 +1,257 @@
+/*
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2026, Analog Devices, Inc.
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * 1. Redistributions of source code must retain the above copyright notice, this
+ *    list of conditions and the following disclaimer.
+ *
+ * 2. Redistributions in binary form must reproduce the above copyright notice,
+ *    this list of conditions and the following disclaimer in the documentation
+ *    and/or other materials provided with the distribution.
+ *
+ * 3. Neither the name of the copyright holder nor the names of its
+ *    contributors may be used to endorse or promote products derived from
+ *    this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+#include "server_test.h"
+#include "tile_delta.h"
+
+#include <cstdlib>
+#include <cstring>
+
+namespace {
+
+struct Planes {
+    uint16_t content; // FrameContent bits, 0 for PCM
+    size_t confOffset;
+    size_t confBytes; // conf is only sent along with the other planes
+};
+
+Planes planes_of(uint16_t layout, size_t plane) {
+    Planes planes = {};
+    if (layout & FRAME_LAYOUT_SELECTED) {
+        planes.content = layout & (FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB |
+                                   FRAME_CONTENT_CONF |
+                                   FRAME_CONTENT_METADATA);
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB_CONF) {
+        planes.content =
+            FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB | FRAME_CONTENT_CONF;
+    } else if (layout == FRAME_LAYOUT_DEPTH_AB) {
+        planes.content = FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB;
+    }
+    if ((planes.content & FRAME_CONTENT_CONF) &&
+        (planes.content & (FRAME_CONTENT_DEPTH | FRAME_CONTENT_AB))) {
+        planes.confOffset =
+            ((planes.content & FRAME_CONTENT_DEPTH) ? plane * 2 : 0) +
+            ((planes.content & FRAME_CONTENT_AB) ? plane * 2 : 0);
+        planes.confBytes = plane * 4;
+    }
+    return planes;
+}
+
+size_t encode(TileDeltaEncoder &encoder, const std::vector<uint8_t> &frame,
+              std::vector<uint8_t> &out) {
+    out.resize(encoder.maxEncodedSize());
+    if (!encoder.begin()) {
+        // Rows are independent, the order they are compared in doesn't matter
+        for (size_t row = encoder.tileRowCount(); row > 0; --row) {
+            encoder.compareTileRow(frame.data(), row - 1);
+        }
+    }
+    out.resize(encoder.finish(frame.data(), out.data()));
+    return out.size();
+}
+
+bool check_stream(uint16_t layout, uint16_t width, uint16_t height,
+                  uint16_t planeCount, std::mt19937 &rng) {
+    const size_t size = layout_frame_size(layout, width, height, planeCount);
+    const Planes planes =
+        planes_of(layout, static_cast<size_t>(width) * height);
+    TileDeltaEncoder encoder;
+    TileDeltaDecoder decoder;
+    EXPECT(encoder.configure(layout, width, height, planeCount, size, 16, 0,
+                             5) == aditof::Status::OK);
+
+    std::vector<uint8_t> frame = make_frame(size, rng);
+    std::vector<uint8_t> encoded;
+    for (int i = 0; i < 12; ++i) {
+        // A few pixels change from a frame to the next
+        for (int j = 0; j < 3; ++j) {
+            frame[rng() % (size / 2) * 2] += (rng() % 2) ? 1 : 50;
+        }
+        encode(encoder, frame, encoded);
+        const bool keyframe = encoder.changedTiles() == encoder.tileCount();
+        EXPECT(decoder.decode(encoded.data(), encoded.size()) ==
+               aditof::Status::OK);
+        EXPECT(decoder.frame().size() == size);
+
+        // Compared planes and runs are exact with a threshold of 0, conf
+        // alongside other planes only when its tile is sent
+        if (keyframe || !planes.confBytes) {
+            EXPECT(decoder.frame() == frame);
+        } else {
+            EXPECT(!memcmp(decoder.frame().data(), frame.data(),
+                           planes.confOffset));
+            const size_t confEnd = planes.confOffset + planes.confBytes;
+            EXPECT(!memcmp(decoder.frame().data() + confEnd,
+                           frame.data() + confEnd, size - confEnd));
+        }
+    }
+
+    // Nothing changed, nothing but the runs is sent
+    encode(encoder, frame, encoded);
+    if (encoder.changedTiles() != encoder.tileCount()) {
+        EXPECT(encoder.changedTiles() == 0);
+        EXPECT(decoder.decode(encoded.data(), encoded.size()) ==
+               aditof::Status::OK);
+
+        // A client that missed the keyframe has nothing to apply it to
+        TileDeltaDecoder late;
+        EXPECT(late.decode(encoded.data(), encoded.size()) ==
+               aditof::Status::UNAVAILABLE);
+        decoder.reset();
+        EXPECT(decoder.decode(encoded.data(), encoded.size()) ==
+               aditof::Status::UNAVAILABLE);
+    }
+    return true;
+}
+
+bool check_threshold() {
+    std::mt19937 rng(3);
+    const uint16_t width = 64;
+    const uint16_t height = 48;
+    const uint16_t threshold = 5;
+    const size_t plane = static_cast<size_t>(width) * height;
+    const size_t size =
+        layout_frame_size(FRAME_LAYOUT_DEPTH_AB, width, height, 1);
+    TileDeltaEncoder encoder;
+    TileDeltaDecoder decoder;
+    EXPECT(encoder.configure(FRAME_LAYOUT_DEPTH_AB, width, height, 1, size,
+                             16, threshold, 100) == aditof::Status::OK);
+
+    std::vector<uint8_t> frame = make_frame(size, rng);
+    std::vector<uint8_t> encoded;
+    for (int i = 0; i < 20; ++i) {
+        for (size_t j = 0; j < size; j += 2) {
+            uint16_t value;
+            memcpy(&value, &frame[j], sizeof(value));
+            value = static_cast<uint16_t>(value + rng() % 5 - 2);
+            memcpy(&frame[j], &value, sizeof(value));
+        }
+        encode(encoder, frame, encoded);
+        EXPECT(decoder.decode(encoded.data(), encoded.size()) ==
+               aditof::Status::OK);
+
+        // The metadata at the start of AB is sent as it is
+        EXPECT(!memcmp(decoder.frame().data() + plane * 2,
+                       frame.data() + plane * 2, FRAME_METADATA_SIZE));
+        for (size_t j = 0; j < size; j += 2) {
+            uint16_t sent;
+            uint16_t value;
+            memcpy(&sent, &decoder.frame()[j], sizeof(sent));
+            memcpy(&value, &frame[j], sizeof(value));
+            EXPECT(std::abs(int(sent) - int(value)) <= threshold);
+        }
+    }
+    return true;
+}
+
+bool check_streams() {
+    std::mt19937 rng(4);
+    const uint16_t layouts[] = {
+        FRAME_LAYOUT_DEPTH_AB_CONF,
+        FRAME_LAYOUT_DEPTH_AB,
+        FRAME_LAYOUT_PCM,
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_DEPTH | FRAME_CONTENT_METADATA,
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_CONF,
+        FRAME_LAYOUT_SELECTED | FRAME_CONTENT_AB | FRAME_CONTENT_CONF};
+    for (uint16_t width : {64, 100}) {
+        for (uint16_t height : {48, 37}) {
+            for (uint16_t layout : layouts) {
+                EXPECT(check_stream(layout, width, height, 3, rng));
+            }
+        }
+    }
+
+    TileDeltaEncoder encoder;
+    EXPECT(encoder.configure(FRAME_LAYOUT_DEPTH_AB, 64, 48, 1, 1000, 16, 0,
+                             5) == aditof::Status::INVALID_ARGUMENT);
+    EXPECT(encoder.configure(FRAME_LAYOUT_DEPTH_AB, 64, 48, 1, 64 * 48 * 4, 2,
+                             0, 5) == aditof::Status::INVALID_ARGUMENT);
+    return true;
+}
+
+bool check_malformed() {
+    std::mt19937 rng(5);
+    const uint16_t width = 64;
+    const uint16_t height = 48;
+    const size_t size =
+        layout_frame_size(FRAME_LAYOUT_DEPTH_AB_CONF, width, height, 1);
+    TileDeltaEncoder encoder;
+    EXPECT(encoder.configure(FRAME_LAYOUT_DEPTH_AB_CONF, width, height, 1,
+                             size, 16, 0, 5) == aditof::Status::OK);
+    std::vector<uint8_t> encoded;
+    encode(encoder, make_frame(size, rng), encoded);
+
+    TileDeltaDecoder decoder;
+    EXPECT(decoder.decode(encoded.data(), sizeof(TileDeltaHeader) - 1) ==
+           aditof::Status::INVALID_ARGUMENT);
+    EXPECT(decoder.decode(encoded.data(), encoded.size() - 1) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    std::vector<uint8_t> bad = encoded;
+    bad[0] ^= 0xff;
+    EXPECT(decoder.decode(bad.data(), bad.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    // A plane that claims to lie past the end of the frame
+    bad = encoded;
+    TileDeltaPlane plane;
+    memcpy(&plane, bad.data() + sizeof(TileDeltaHeader), sizeof(plane));
+    plane.offset = static_cast<uint32_t>(size);
+    memcpy(bad.data() + sizeof(TileDeltaHeader), &plane, sizeof(plane));
+    EXPECT(decoder.decode(bad.data(), bad.size()) ==
+           aditof::Status::INVALID_ARGUMENT);
+
+    // Corrupted frames must be rejected or applied, never read or write out
+    // of bounds
+    for (int i = 0; i < 1000; ++i) {
+        bad = encoded;
+        bad[rng() % bad.size()] = static_cast<uint8_t>(rng());
+        decoder.decode(bad.data(), bad.size());
+    }
+    EXPECT(decoder.decode(encoded.data(), encoded.size()) ==
+           aditof::Status::OK);
+    return true;
+}
+
+} // namespace
+
+int main(int, char *argv[]) {
+    google::InitGoogleLogging(argv[0]);
+    FLAGS_alsologtostderr = 1;
+
+    bool passed = check_streams();
+    passed = check_threshold() && passed;
+    passed = check_malformed() && passed;
+    if (passed) {
+        LOG(INFO) << "@@," << TEST_NAME << ",PASS,LN" << __LINE__;
+    }
+    return passed ? 0 : 1;
+}